@@ -14,8 +14,6 @@ using namespace std;
 using namespace lcg;
 using namespace pb;
 
-const int PERIODNUM = 4;
-
 
 
 int vehicleVolume(const pb::OilDelivery_Vehicle& vehicle) {
@@ -71,10 +69,15 @@ int main(int argc, char *argv[]) {
 	double sumTotal = 0.0;	// objective
 
 	int stationNumber = input.gasstations_size();
+	// the number of periods is the length of the demand lists
+	int periodNumber = 0;
+	for (auto station = input.gasstations().begin(); station != input.gasstations().end(); ++station) {
+		if (station->demandvalues_size() > periodNumber) { periodNumber = station->demandvalues_size(); }
+	}
 	int *oilSum = new int[stationNumber] { 0 };			// oilSum[i]: sum of oil deliveried to gas station i
-	int *deliveriedTimes = new int[stationNumber * PERIODNUM]{ 0 };	// deliveried times of each station in all periods
+	int *deliveriedTimes = new int[stationNumber * periodNumber]{ 0 };	// deliveried times of each station in all periods
 
-	if (output.deliveries_size() != PERIODNUM) { error |= CheckerFlag::FormatError; }
+	if (output.deliveries_size() != periodNumber) { error |= CheckerFlag::FormatError; }
 	int period = 0;
 	for (auto delivery = output.deliveries().begin(); delivery != output.deliveries().end(); ++delivery, ++period) {
 
@@ -86,7 +89,7 @@ int main(int argc, char *argv[]) {
 			auto vehicleInput = input.vehicles(vehicleDelivery->id());
 			// intermediate variables to count objective `sumTotal`
 			double vehicleValue = 0.0, fullLoadRate = 0.0, loadSharing = 0.0;
-			int vehicleLoad = 0, maxStationId = 0, minStationId = 0;
+			int vehicleLoad = 0, maxStationId = -1, minStationId = stationNumber;
 
 			// each vehicle must delivery only one time in each period
 			if (vehicleDeliverySet.find(vehicleDelivery->id()) != vehicleDeliverySet.end()) { error |= CheckerFlag::VehicleDispatchError; }
@@ -110,6 +113,8 @@ int main(int argc, char *argv[]) {
 				if (cabinDelivery->stationid() > maxStationId) { maxStationId = cabinDelivery->stationid(); }
 				if (cabinDelivery->stationid() < minStationId) { minStationId = cabinDelivery->stationid(); }
 			}
+			// an idle vehicle earns nothing
+			if (vehicleLoad <= 0) { continue; }
 			// full load rate
 			fullLoadRate = 1.0*vehicleLoad / vehicleVolume(vehicleInput);
 			// load sharing
@@ -121,7 +126,7 @@ int main(int argc, char *argv[]) {
 	// if a station is deliveried in more than one period
 	for (int i = 0; i < stationNumber; ++i) {
 		int number = 0;
-		for (int j = 0; j < PERIODNUM; ++j) {
+		for (int j = 0; j < periodNumber; ++j) {
 			number += deliveriedTimes[i + j * stationNumber];
 			if (number > 1) {
 				error |= CheckerFlag::StationOverTimeError;
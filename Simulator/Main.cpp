@@ -12,6 +12,7 @@ int main() {
     //sim.debug();
     //sim.benchmark(1);
     sim.parallelBenchmark(1);
+    //sim.benchmarkMinCostFlow();
     //sim.generateInstance();
 
     return 0;
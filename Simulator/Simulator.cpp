@@ -167,6 +167,70 @@ void Simulator::parallelBenchmark(int repeat) {
     }
 }
 
+void Simulator::benchmarkMinCostFlow(int batchNum) {
+    struct Holder {
+        int station;
+        int capacity;
+        double gain;
+    };
+    struct Batch {
+        vector<int> demands;
+        vector<Holder> holders;
+    };
+
+    // random batches of stations shared by 2 to 6 cabins, which fill most of a transportation network.
+    Random rand(0);
+    vector<Batch> batches(batchNum);
+    for (auto b = batches.begin(); b != batches.end(); ++b) {
+        for (int arcNum = 0; arcNum < Solver::MaxSplitArcNum - 60;) {
+            int holderNum = rand.pick(2, 7);
+            arcNum += holderNum + 1;
+            b->demands.push_back(rand.pick(10, 100));
+            for (int h = 0; h < holderNum; ++h) {
+                b->holders.push_back({ static_cast<int>(b->demands.size()) - 1, rand.pick(5, 45), rand.pick(100, 1100) / 100.0 });
+            }
+        }
+    }
+
+    Solver::Transportation transportation;
+    vector<int> arcs;
+    double flowValue = 0.0;
+    Timer::TimePoint start = Timer::Clock::now();
+    for (auto b = batches.begin(); b != batches.end(); ++b) {
+        transportation.clear(Solver::MaxSplitArcNum + 2);
+        for (int s = 0; s < static_cast<int>(b->demands.size()); ++s) { transportation.addArc(0, s + 2, b->demands[s], 0.0); }
+        arcs.clear();
+        for (auto h = b->holders.begin(); h != b->holders.end(); ++h) { arcs.push_back(transportation.addArc(h->station + 2, 1, h->capacity, -h->gain)); }
+        transportation.solve(0, 1);
+        for (size_t h = 0; h < arcs.size(); ++h) { flowValue += b->holders[h].gain * transportation.flowOn(arcs[h]); }
+    }
+    double flowTime = Timer::durationInSecond(start, Timer::Clock::now());
+
+    // fill the cabins of each station in decreasing gain.
+    vector<int> order;
+    vector<int> restDemands;
+    double greedyValue = 0.0;
+    start = Timer::Clock::now();
+    for (auto b = batches.begin(); b != batches.end(); ++b) {
+        const vector<Holder> &holders(b->holders);
+        order.resize(holders.size());
+        for (size_t i = 0; i < order.size(); ++i) { order[i] = static_cast<int>(i); }
+        sort(order.begin(), order.end(), [&](int l, int r) {
+            return (holders[l].station != holders[r].station) ? (holders[l].station < holders[r].station) : (holders[l].gain > holders[r].gain);
+        });
+        restDemands = b->demands;
+        for (auto i = order.begin(); i != order.end(); ++i) {
+            int quantity = (min)(restDemands[holders[*i].station], holders[*i].capacity);
+            restDemands[holders[*i].station] -= quantity;
+            greedyValue += holders[*i].gain * quantity;
+        }
+    }
+    double greedyTime = Timer::durationInSecond(start, Timer::Clock::now());
+
+    cout << "min-cost flow: " << flowTime / batchNum * 1e6 << "us and " << flowValue / batchNum << " per batch." << endl
+        << "greedy: " << greedyTime / batchNum * 1e6 << "us and " << greedyValue / batchNum << " per batch." << endl;
+}
+
 void Simulator::generateInstance(const InstanceTrait &trait) {
 
     Random rand;
@@ -209,7 +273,7 @@ void Simulator::generateInstance(const InstanceTrait &trait) {
 	}
 
     ostringstream path;
-	path << InstanceDir() << "rand.p4s"
+	path << InstanceDir() << "rand.p" << trait.periodNum << "s"
 		<< input.gasstations_size()
 		<< "v" << input.vehicles_size()
 		<< ".json";
@@ -39,7 +39,7 @@ public:
     };
 
     struct InstanceTrait {
-		int periodNum = 4;
+		int periodNum = Problem::DefaultPeriodNum;
         Interval<int> stationNum = Interval<int>(10, Problem::MaxStationNum);
         Interval<int> vehicleNum = Interval<int>(2, Problem::MaxVehicleNum);
 		Interval<int> cabinNum = Interval<int>(1, Problem::MaxCabinNum);
@@ -80,6 +80,8 @@ public:
     void benchmark(int repeat = 1);
     // utility for testing all instances using a thread pool.
     void parallelBenchmark(int repeat);
+    // utility for comparing the min-cost flow with the greedy split of shared station demands.
+    void benchmarkMinCostFlow(int batchNum = 2000);
 
 
     void generateInstance(const InstanceTrait &trait);
@@ -0,0 +1,143 @@
+////////////////////////////////
+/// usage : 1.	bit sets of station ids with word-level enumeration.
+///
+/// note  : 1.	the first 128 bits are stored inline, which covers the benchmark instances
+///             without heap allocation. larger sets grow dynamically.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_BITSET_H
+#define SMART_LCG_OIL_DELIVERY_BITSET_H
+
+
+#include "Config.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <cstdint>
+
+#if _CC_MS_VC
+#include <intrin.h>
+#endif // _CC_MS_VC
+
+
+namespace lcg {
+
+class Bitset {
+public:
+    using Word = std::uint64_t;
+
+
+    static constexpr int WordBits = 64;
+    static constexpr int InlineWordNum = 2;
+
+
+    static int popcount(Word w) {
+        #if _CC_MS_VC && defined(_M_X64)
+        return static_cast<int>(__popcnt64(w));
+        #elif _CC_MS_VC // the 64-bit intrinsics are missing on 32-bit targets.
+        return static_cast<int>(__popcnt(static_cast<unsigned>(w)) + __popcnt(static_cast<unsigned>(w >> 32)));
+        #else
+        return __builtin_popcountll(w);
+        #endif // _CC_MS_VC
+    }
+
+    // w must not be 0.
+    static int ctz(Word w) {
+        #if _CC_MS_VC && defined(_M_X64)
+        unsigned long i;
+        _BitScanForward64(&i, w);
+        return static_cast<int>(i);
+        #elif _CC_MS_VC
+        unsigned long i;
+        if (_BitScanForward(&i, static_cast<unsigned long>(w))) { return static_cast<int>(i); }
+        _BitScanForward(&i, static_cast<unsigned long>(w >> 32));
+        return static_cast<int>(i) + 32;
+        #else
+        return __builtin_ctzll(w);
+        #endif // _CC_MS_VC
+    }
+
+    static int wordNumOf(int bitNum) { return (bitNum + WordBits - 1) / WordBits; }
+
+
+    explicit Bitset(int bitNum = 0) { resize(bitNum); }
+
+
+    // all bits are reset.
+    void resize(int bitNum) {
+        len = bitNum;
+        wordNum = wordNumOf(bitNum);
+        std::fill(inlineWords, inlineWords + InlineWordNum, 0);
+        heapWords.assign((wordNum > InlineWordNum) ? wordNum : 0, 0);
+    }
+
+    void clear() { std::fill(data(), data() + wordNum, 0); }
+
+    bool test(int i) const { return ((data()[i / WordBits] >> (i % WordBits)) & 1) != 0; }
+    void set(int i) { data()[i / WordBits] |= (Word(1) << (i % WordBits)); }
+    void reset(int i) { data()[i / WordBits] &= ~(Word(1) << (i % WordBits)); }
+    void assign(int i, bool value) { value ? set(i) : reset(i); }
+
+    int count() const {
+        int n = 0;
+        for (int w = 0; w < wordNum; ++w) { n += popcount(data()[w]); }
+        return n;
+    }
+
+    Word* data() { return heapWords.empty() ? inlineWords : heapWords.data(); }
+    const Word* data() const { return heapWords.empty() ? inlineWords : heapWords.data(); }
+    Word word(int w) const { return data()[w]; }
+
+    int size() const { return len; }
+    int words() const { return wordNum; }
+
+    // keep the bits of the w_th word in [lo, hi].
+    static Word clip(int w, Word bits, int lo, int hi) {
+        int first = w * WordBits;
+        if (lo > first) { bits &= (~Word(0) << (lo - first)); }
+        if (hi < first + WordBits - 1) { bits &= ((Word(1) << (hi - first + 1)) - 1); }
+        return bits;
+    }
+
+    // call visit(i) in increasing order for every set bit i in [lo, hi] of the words produced by
+    // combine(w), e.g., [&](int w) { return a.word(w) & b.word(w); } for the intersection of a and b.
+    template<typename Combine, typename Visit>
+    static void enumerate(int wordNum, Combine combine, Visit visit, int lo, int hi) {
+        hi = (std::min)(hi, wordNum * WordBits - 1);
+        for (int w = lo / WordBits; (lo <= hi) && (w <= hi / WordBits); ++w) {
+            for (Word bits = clip(w, combine(w), lo, hi); bits != 0; bits &= (bits - 1)) {
+                visit(w * WordBits + ctz(bits));
+            }
+        }
+    }
+    template<typename Combine, typename Visit>
+    static void enumerate(int wordNum, Combine combine, Visit visit) {
+        enumerate(wordNum, combine, visit, 0, wordNum * WordBits - 1);
+    }
+
+    // the number of set bits in [lo, hi] of the words produced by combine(w).
+    template<typename Combine>
+    static int count(int wordNum, Combine combine, int lo, int hi) {
+        int n = 0;
+        hi = (std::min)(hi, wordNum * WordBits - 1);
+        for (int w = lo / WordBits; (lo <= hi) && (w <= hi / WordBits); ++w) {
+            n += popcount(clip(w, combine(w), lo, hi));
+        }
+        return n;
+    }
+
+    template<typename Visit>
+    void forEach(Visit visit) const { enumerate(wordNum, [this](int w) { return word(w); }, visit); }
+
+protected:
+    Word inlineWords[InlineWordNum];
+    std::vector<Word> heapWords;
+    int wordNum;
+    int len;
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_BITSET_H
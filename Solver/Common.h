@@ -10,6 +10,7 @@
 
 #include <vector>
 #include <set>
+#include <unordered_set>
 #include <map>
 #include <string>
 
@@ -35,6 +36,9 @@ using List = std::vector<T>;
 template<typename T>
 using Set = std::set<T>;
 
+template<typename T>
+using HashSet = std::unordered_set<T>;
+
 template<typename Key, typename Val>
 using Map = std::map<Key, Val>;
 
@@ -99,6 +99,8 @@
 
 
 #pragma region SolverBehavior
+// [on] use the simd kernels if both the compiler and the cpu support them.
+#define LCG_SIMD  1
 #pragma endregion SolverBehavior
 
 
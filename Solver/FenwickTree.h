@@ -0,0 +1,59 @@
+////////////////////////////////
+/// usage : 1.	binary indexed trees for prefix sums under point updates.
+///
+/// note  : 1.	indices start from 0 and ranges are inclusive on both ends.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_FENWICK_TREE_H
+#define SMART_LCG_OIL_DELIVERY_FENWICK_TREE_H
+
+
+#include "Config.h"
+
+#include <vector>
+
+
+namespace lcg {
+
+template<typename T>
+class FenwickTree {
+public:
+    explicit FenwickTree(int itemNum = 0) { init(itemNum); }
+
+
+    // all items are 0.
+    void init(int itemNum) { tree.assign(itemNum + 1, T()); }
+    // O(n) construction from items[0, itemNum).
+    template<typename Iterator>
+    void init(Iterator items, int itemNum) {
+        tree.assign(itemNum + 1, T());
+        for (int i = 1; i <= itemNum; ++i, ++items) {
+            tree[i] += *items;
+            int parent = i + (i & -i);
+            if (parent <= itemNum) { tree[parent] += tree[i]; }
+        }
+    }
+
+    void add(int i, T delta) {
+        for (++i; i < static_cast<int>(tree.size()); i += (i & -i)) { tree[i] += delta; }
+    }
+
+    // the sum of items[0, n).
+    T prefix(int n) const {
+        T sum = T();
+        for (; n > 0; n -= (n & -n)) { sum += tree[n]; }
+        return sum;
+    }
+    // the sum of items[lo, hi].
+    T sum(int lo, int hi) const { return (lo <= hi) ? (prefix(hi + 1) - prefix(lo)) : T(); }
+
+    int size() const { return static_cast<int>(tree.size()) - 1; }
+
+protected:
+    std::vector<T> tree; // tree[i] is the sum of items[i - lowbit(i), i).
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_FENWICK_TREE_H
@@ -0,0 +1,127 @@
+////////////////////////////////
+/// usage : 1.	min-cost flow by successive shortest paths for small transportation problems.
+///
+/// note  : 1.	all storage is inline, so no memory is allocated after construction.
+///         2.	arc costs may be negative as long as there is no negative cycle initially.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_MIN_COST_FLOW_H
+#define SMART_LCG_OIL_DELIVERY_MIN_COST_FLOW_H
+
+
+#include "Config.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <cassert>
+
+
+namespace lcg {
+
+template<int MaxNodeNum, int MaxArcNum>
+class MinCostFlow {
+public:
+    static constexpr int InvalidArc = -1;
+    static constexpr double Tolerance = 1e-9;
+
+
+    MinCostFlow() : nodeNum(0), arcNum(0) {}
+
+
+    void clear(int nodeNumber) {
+        nodeNum = nodeNumber;
+        arcNum = 0;
+        std::fill(heads, heads + nodeNum, InvalidArc);
+    }
+
+    bool full(int newArcNum = 1) const { return arcNum + 2 * newArcNum > 2 * MaxArcNum; }
+
+    // return the id of the arc, whose reverse arc is (id ^ 1).
+    int addArc(int src, int dst, int capacity, double cost) {
+        assert(!full() && (src < nodeNum) && (dst < nodeNum));
+        arcs[arcNum] = { dst, heads[src], capacity, cost };
+        heads[src] = arcNum++;
+        arcs[arcNum] = { src, heads[dst], 0, -cost };
+        heads[dst] = arcNum++;
+        return arcNum - 2;
+    }
+
+    // augment along negative cost paths until there is none or maxFlow is reached. return the cost.
+    double solve(int source, int sink, int maxFlow = (std::numeric_limits<int>::max)()) {
+        double totalCost = 0.0;
+        for (int flow = 0; flow < maxFlow;) {
+            if (!findShortestPath(source, sink) || (dists[sink] >= -Tolerance)) { break; }
+            int delta = maxFlow - flow;
+            for (int node = sink; node != source; node = arcs[prevArcs[node] ^ 1].dst) {
+                delta = (std::min)(delta, arcs[prevArcs[node]].capacity);
+            }
+            for (int node = sink; node != source; node = arcs[prevArcs[node] ^ 1].dst) {
+                arcs[prevArcs[node]].capacity -= delta;
+                arcs[prevArcs[node] ^ 1].capacity += delta;
+            }
+            flow += delta;
+            totalCost += delta * dists[sink];
+        }
+        return totalCost;
+    }
+
+    // the flow on an arc returned by addArc().
+    int flowOn(int arc) const { return arcs[arc ^ 1].capacity; }
+
+protected:
+    static constexpr int QueueSize = MaxNodeNum + 1;
+
+
+    struct Arc {
+        int dst;
+        int next; // the next arc from the same source.
+        int capacity; // residual capacity.
+        double cost;
+    };
+
+
+    // Bellman-Ford with a FIFO queue on the residual network.
+    bool findShortestPath(int source, int sink) {
+        std::fill(dists, dists + nodeNum, (std::numeric_limits<double>::max)());
+        std::fill(inQueue, inQueue + nodeNum, false);
+        int head = 0;
+        int tail = 0;
+        dists[source] = 0.0;
+        queue[tail++] = source;
+        inQueue[source] = true;
+        while (head != tail) {
+            int node = queue[head];
+            head = (head + 1) % QueueSize;
+            inQueue[node] = false;
+            for (int a = heads[node]; a != InvalidArc; a = arcs[a].next) {
+                if (arcs[a].capacity <= 0) { continue; }
+                double dist = dists[node] + arcs[a].cost;
+                if (dist >= dists[arcs[a].dst] - Tolerance) { continue; }
+                dists[arcs[a].dst] = dist;
+                prevArcs[arcs[a].dst] = a;
+                if (inQueue[arcs[a].dst]) { continue; }
+                queue[tail] = arcs[a].dst;
+                tail = (tail + 1) % QueueSize;
+                inQueue[arcs[a].dst] = true;
+            }
+        }
+        return dists[sink] < (std::numeric_limits<double>::max)();
+    }
+
+
+    int nodeNum;
+    int arcNum;
+    int heads[MaxNodeNum];
+    Arc arcs[2 * MaxArcNum];
+
+    double dists[MaxNodeNum];
+    int prevArcs[MaxNodeNum];
+    int queue[QueueSize]; // circular, each node is queued at most once at a time.
+    bool inQueue[MaxNodeNum];
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_MIN_COST_FLOW_H
@@ -34,10 +34,11 @@ std::string protobufToJson(const T &obj, bool pretty = true) {
     return data;
 }
 
+// return false if data is not a json of the message.
 template<typename T>
-void jsonToProtobuf(const std::string &data, T &obj) {
+bool jsonToProtobuf(const std::string &data, T &obj) {
     google::protobuf::util::JsonParseOptions options;
-    google::protobuf::util::JsonStringToMessage(data, &obj, options);
+    return google::protobuf::util::JsonStringToMessage(data, &obj, options).ok();
 }
 
 template<typename T>
@@ -0,0 +1,56 @@
+////////////////////////////////
+/// usage : 1.	pheromone trails of the ant colony on (station, period) and (vehicle, window start).
+///
+/// note  : 1.	both trails live in one flat array, so 100 stations in 4 periods with a few
+///             vehicles take a few kilobytes and stay in the cache during construction.
+///         2.	the trails are read concurrently by the ants and only updated between batches.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_PHEROMONE_H
+#define SMART_LCG_OIL_DELIVERY_PHEROMONE_H
+
+
+#include "Config.h"
+
+#include <algorithm>
+#include <vector>
+
+
+namespace lcg {
+
+class Pheromone {
+public:
+    void init(int stationNumber, int periodNumber, int vehicleNumber, double initialTrail) {
+        stationNum = stationNumber;
+        periodNum = periodNumber;
+        windowOffset = stationNum * periodNum;
+        trails.assign(windowOffset + vehicleNumber * stationNum, initialTrail);
+    }
+
+    double stationPeriod(int station, int period) const { return trails[station * periodNum + period]; }
+    double vehicleWindow(int vehicle, int windowStart) const { return trails[windowOffset + vehicle * stationNum + windowStart]; }
+
+    void depositStationPeriod(int station, int period, double amount) { trails[station * periodNum + period] += amount; }
+    void depositVehicleWindow(int vehicle, int windowStart, double amount) { trails[windowOffset + vehicle * stationNum + windowStart] += amount; }
+
+    // scale all trails by (1 - rate).
+    void evaporate(double rate) {
+        for (auto t = trails.begin(); t != trails.end(); ++t) { *t *= (1 - rate); }
+    }
+
+    // keep all trails in [minTrail, maxTrail] so that no choice is ruled out or fixed.
+    void clamp(double minTrail, double maxTrail) {
+        for (auto t = trails.begin(); t != trails.end(); ++t) { *t = (std::min)((std::max)(*t, minTrail), maxTrail); }
+    }
+
+protected:
+    int stationNum;
+    int periodNum;
+    int windowOffset; // trails[windowOffset + vehicle * stationNum + windowStart].
+    std::vector<double> trails; // trails[station * periodNum + period] for the stations.
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_PHEROMONE_H
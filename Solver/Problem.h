@@ -29,6 +29,18 @@ public:
     };
 
     struct Output : public pb::OilDelivery::Output {
+        // read the solution part of a submission file (the first line is the submission summary).
+        bool load(const String &path) {
+            std::ifstream ifs(path);
+            if (!ifs.is_open()) { return false; }
+
+            String submission;
+            std::getline(ifs, submission);
+            std::ostringstream oss;
+            oss << ifs.rdbuf();
+            return pb::jsonToProtobuf(oss.str(), *this);
+        }
+
         bool save(const String &path, pb::OilDelivery_Submission &submission) const {
             std::ofstream ofs(path);
             if (!ofs.is_open()) { return false; }
@@ -53,11 +65,12 @@ public:
 
     #pragma region Constant
 public:
+	// limits of the generated benchmark instances. the solver takes the actual sizes from the input.
 	enum {
 		MaxStationNum = 110,
 		MaxVehicleNum = 10,
 		MaxCabinNum = 5,
-		PeriodNum = 4,
+		DefaultPeriodNum = 4,
 		MaxDemand = 60,
 		MaxValue = 100,
 		MaxCabinVolume = 15,
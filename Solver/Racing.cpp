@@ -0,0 +1,161 @@
+#include "Racing.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include <cmath>
+
+
+using namespace std;
+
+
+namespace lcg {
+
+void Race::start(int contestant) {
+    unique_lock<mutex> lock(mtx);
+    cv.wait(lock, [&]() { return states[contestant] != State::Waiting; });
+}
+
+bool Race::yield(int contestant, double obj) {
+    unique_lock<mutex> lock(mtx);
+    if (over) { return true; }
+    objs[contestant] = obj;
+    states[contestant] = State::Yielded;
+    --runningNum;
+    cv.notify_all();
+    cv.wait(lock, [&]() { return (states[contestant] == State::Running) || (states[contestant] == State::Eliminated); });
+    return states[contestant] != State::Eliminated;
+}
+
+void Race::finish(int contestant) {
+    lock_guard<mutex> guard(mtx);
+    if ((states[contestant] == State::Running) && !over) { --runningNum; }
+    if (states[contestant] != State::Eliminated) { states[contestant] = State::Finished; }
+    cv.notify_all();
+}
+
+void Race::run(const function<bool()> &isTimeout) {
+    unique_lock<mutex> lock(mtx);
+    while (!over) {
+        // grant the slots to the waiting contestants in increasing id, then wait for all of them to yield.
+        for (int c = 0; c < contestantNum;) {
+            if (isTimeout()) {
+                callOff();
+                return;
+            } else if (states[c] != State::Waiting) {
+                ++c;
+            } else if (runningNum < slotNum) {
+                states[c++] = State::Running;
+                ++runningNum;
+                cv.notify_all();
+            } else {
+                cv.wait(lock);
+            }
+        }
+        cv.wait(lock, [&]() { return runningNum == 0; });
+        if (isTimeout()) {
+            callOff();
+            return;
+        }
+
+        // the contestants which finish in the round, e.g., on timeout, have left the race.
+        vector<int> contestants;
+        for (int c = 0; c < contestantNum; ++c) {
+            if (states[c] == State::Yielded) { contestants.push_back(c); }
+        }
+        if (static_cast<int>(contestants.size()) <= slotNum) {
+            over = true;
+            for (auto c = contestants.begin(); c != contestants.end(); ++c) { states[*c] = State::Running; }
+        } else {
+            rounds.push_back(objs);
+            if (roundNumber() >= minRoundNum) {
+                vector<int> losers(eliminate(rounds, contestants));
+                for (auto c = losers.begin(); c != losers.end(); ++c) { states[*c] = State::Eliminated; }
+            }
+            for (auto c = contestants.begin(); c != contestants.end(); ++c) {
+                if (states[*c] == State::Yielded) { states[*c] = State::Waiting; }
+            }
+        }
+        cv.notify_all();
+    }
+}
+
+void Race::callOff() {
+    int leader = -1;
+    for (int c = 0; c < contestantNum; ++c) {
+        if ((states[c] != State::Waiting) && (states[c] != State::Yielded)) { continue; }
+        if ((leader < 0) || (objs[c] > objs[leader])) { leader = c; }
+    }
+    for (int c = 0; c < contestantNum; ++c) {
+        if ((states[c] == State::Waiting) || (states[c] == State::Yielded)) { states[c] = State::Eliminated; }
+    }
+    if (leader >= 0) { states[leader] = State::Running; }
+    over = true;
+    cv.notify_all();
+}
+
+vector<int> Race::eliminate(const vector<vector<double>> &rounds, const vector<int> &contestants) {
+    vector<int> losers;
+    int k = static_cast<int>(contestants.size());
+    int b = static_cast<int>(rounds.size());
+    if ((k < 2) || (b < 2)) { return losers; }
+
+    // rank the contestants in each round with the average rank for ties.
+    vector<double> rankSums(k, 0.0);
+    double rankSquareSum = 0.0;
+    vector<int> order(k);
+    for (auto r = rounds.begin(); r != rounds.end(); ++r) {
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](int l, int h) { return (*r)[contestants[l]] > (*r)[contestants[h]]; });
+        for (int i = 0, j = 0; i < k; i = j) {
+            for (j = i + 1; (j < k) && ((*r)[contestants[order[j]]] == (*r)[contestants[order[i]]]); ++j) {}
+            double rank = (i + j + 1) / 2.0;
+            for (int t = i; t < j; ++t) { rankSums[order[t]] += rank; }
+            rankSquareSum += (j - i) * rank * rank;
+        }
+    }
+
+    // the friedman statistic with ties, which follows the chi-square distribution with k - 1 degrees.
+    double spread = rankSquareSum - b * k * (k + 1) * (k + 1) / 4.0;
+    if (spread <= 0) { return losers; } // all contestants tie in every round.
+    double meanRankSum = b * (k + 1) / 2.0;
+    double stat = 0.0;
+    for (int i = 0; i < k; ++i) { stat += (rankSums[i] - meanRankSum) * (rankSums[i] - meanRankSum); }
+    stat *= (k - 1) / spread;
+    if (stat <= chiSquareQuantile(1 - Alpha, k - 1)) { return losers; }
+
+    // the post-hoc test compares the rank sum of each contestant with the best one.
+    int best = static_cast<int>(min_element(rankSums.begin(), rankSums.end()) - rankSums.begin());
+    int degree = (b - 1) * (k - 1);
+    double criticalDiff = tQuantile(1 - Alpha / 2, degree)
+        * sqrt((max)(0.0, 2 * b * (1 - stat / (b * (k - 1))) * spread / degree));
+    for (int i = 0; i < k; ++i) {
+        if (rankSums[i] - rankSums[best] > criticalDiff) { losers.push_back(contestants[i]); }
+    }
+    return losers;
+}
+
+double Race::chiSquareQuantile(double p, int degree) {
+    // wilson-hilferty approximation.
+    double h = 2.0 / (9 * degree);
+    double c = 1 - h + normalQuantile(p) * sqrt(h);
+    return degree * c * c * c;
+}
+
+double Race::tQuantile(double p, int degree) {
+    // cornish-fisher expansion around the normal quantile.
+    double z = normalQuantile(p);
+    double z2 = z * z;
+    double n = degree;
+    return z + z * (z2 + 1) / (4 * n) + z * ((5 * z2 + 16) * z2 + 3) / (96 * n * n)
+        + z * (((3 * z2 + 19) * z2 + 17) * z2 - 15) / (384 * n * n * n);
+}
+
+double Race::normalQuantile(double p) {
+    // abramowitz and stegun 26.2.23 with an absolute error below 4.5e-4.
+    if (p < 0.5) { return -normalQuantile(1 - p); }
+    double t = sqrt(-2 * log(1 - p));
+    return t - (2.515517 + (0.802853 + 0.010328 * t) * t) / (1 + (1.432788 + (0.189269 + 0.001308 * t) * t) * t);
+}
+
+}
@@ -0,0 +1,89 @@
+////////////////////////////////
+/// usage : 1.	race many contestants on a few threads and eliminate the ones statistically behind (F-race).
+///
+/// note  : 1.	each contestant runs on its own thread, but only slotNum of them hold a slot at a time.
+///             a contestant gives up its slot by yield() and is parked until its turn in the next round,
+///             so the contestants are cooperative coroutines on slotNum running threads.
+///         2.	a round ends when every contestant in the race has yielded once. the rounds are the
+///             blocks of the friedman test, and the contestants are ranked in each of them by the
+///             objective they report.
+///         3.	the race is over once no more contestants are left than slots, and the rest run freely.
+///             on timeout, the parked contestants except the leader are eliminated at once.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_RACING_H
+#define SMART_LCG_OIL_DELIVERY_RACING_H
+
+
+#include "Config.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+namespace lcg {
+
+class Race {
+public:
+    static constexpr double Alpha = 0.05; // the significance level of the tests.
+
+
+    Race(int contestantNumber, int slotNumber, int minRoundNumber)
+        : contestantNum(contestantNumber), slotNum(slotNumber), minRoundNum(minRoundNumber),
+        states(contestantNumber, State::Waiting), objs(contestantNumber, 0.0), runningNum(0), over(false) {}
+
+
+    // called by the contestants.
+    // wait for the first turn.
+    void start(int contestant);
+    // report the objective and wait for the next turn. return false if the contestant is eliminated.
+    bool yield(int contestant, double obj);
+    // leave the race for good.
+    void finish(int contestant);
+
+    // called by the controller. schedule the rounds until the race is over or isTimeout() returns true.
+    void run(const std::function<bool()> &isTimeout);
+
+    bool isEliminated(int contestant) {
+        std::lock_guard<std::mutex> guard(mtx);
+        return states[contestant] == State::Eliminated;
+    }
+    int roundNumber() const { return static_cast<int>(rounds.size()); }
+
+    // F-race. rounds[r][c] is the objective of contestant c in round r, the larger the better.
+    // return those of contestants statistically worse than the best one by the friedman test and its post-hoc test.
+    static std::vector<int> eliminate(const std::vector<std::vector<double>> &rounds, const std::vector<int> &contestants);
+
+protected:
+    enum State { Waiting, Running, Yielded, Finished, Eliminated };
+
+
+    // the approximate quantiles of the chi-square distribution and the student's t distribution.
+    static double chiSquareQuantile(double p, int degree);
+    static double tQuantile(double p, int degree);
+    static double normalQuantile(double p);
+
+    // end the race and keep the parked contestant with the best objective.
+    void callOff();
+
+
+    int contestantNum;
+    int slotNum;
+    int minRoundNum; // the number of rounds before the first test.
+
+    std::mutex mtx;
+    std::condition_variable cv; // shared by the controller and the contestants.
+    std::vector<State> states;
+    std::vector<double> objs; // the objectives reported by the contestants in the current round.
+    int runningNum;
+    bool over;
+
+    std::vector<std::vector<double>> rounds; // rounds[r] is objs at the end of round r.
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_RACING_H
@@ -0,0 +1,98 @@
+////////////////////////////////
+/// usage : 1.	bounded cache of values keyed by 64-bit hashes, shared by all workers.
+///
+/// note  : 1.	each shard is a direct-mapped table guarded by its own mutex, so concurrent
+///             lookups rarely contend. a newer entry evicts the older one in the same slot.
+///         2.	keys are trusted, so callers should verify the values if collisions matter.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_SHARDED_CACHE_H
+#define SMART_LCG_OIL_DELIVERY_SHARDED_CACHE_H
+
+
+#include "Config.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <cstdint>
+
+
+namespace lcg {
+
+template<typename Value, int ShardNum = 16>
+class ShardedCache {
+public:
+    using Key = std::uint64_t;
+
+
+    explicit ShardedCache(int capacity = 0) { init(capacity); }
+
+
+    // drop all entries and reset the counters.
+    void init(int capacity) {
+        int slotNum = (capacity + ShardNum - 1) / ShardNum;
+        for (int i = 0; i < ShardNum; ++i) {
+            std::lock_guard<std::mutex> guard(shards[i].mtx);
+            shards[i].entries.assign(slotNum, Entry());
+        }
+        hits = 0;
+        misses = 0;
+    }
+
+    bool get(Key key, Value &value) {
+        Shard &shard(shardOf(key));
+        if (!shard.entries.empty()) {
+            std::lock_guard<std::mutex> guard(shard.mtx);
+            const Entry &entry(slotOf(shard, key));
+            if (entry.used && (entry.key == key)) {
+                value = entry.value;
+                ++hits;
+                return true;
+            }
+        }
+        ++misses;
+        return false;
+    }
+
+    void put(Key key, const Value &value) {
+        Shard &shard(shardOf(key));
+        if (shard.entries.empty()) { return; }
+        std::lock_guard<std::mutex> guard(shard.mtx);
+        Entry &entry(slotOf(shard, key));
+        entry.used = true;
+        entry.key = key;
+        entry.value = value;
+    }
+
+    long long hitNum() const { return hits; }
+    long long missNum() const { return misses; }
+
+protected:
+    struct Entry {
+        bool used = false;
+        Key key = 0;
+        Value value;
+    };
+
+    struct Shard {
+        std::mutex mtx;
+        std::vector<Entry> entries;
+    };
+
+
+    // the low bits select the shard and the high bits select the slot.
+    Shard& shardOf(Key key) { return shards[key % ShardNum]; }
+    static Entry& slotOf(Shard &shard, Key key) { return shard.entries[(key >> 32) % shard.entries.size()]; }
+
+
+    Shard shards[ShardNum];
+    std::atomic<long long> hits;
+    std::atomic<long long> misses;
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_SHARDED_CACHE_H
@@ -8,6 +8,8 @@
 #include <thread>
 #include <mutex>
 #include <cmath>
+#include <numeric>
+#include <limits>
 
 using namespace std;
 
@@ -15,6 +17,9 @@ namespace lcg {
 
 #pragma region Solver::Cli
 int Solver::Cli::run(int argc, char * argv[]) {
+    // flush the best solution found so far instead of dying on preemption.
+    Cancellation::handleTerminationSignals();
+
     Log(LogSwitch::LCG::Cli) << "parse command line arguments." << endl;
     Set<String> switchSet;
     Map<String, char*> optionMap({ // use string as key to compare string contents instead of pointers.
@@ -27,7 +32,8 @@ int Solver::Cli::run(int argc, char * argv[]) {
         { RunIdOption(), nullptr },
         { EnvironmentPathOption(), nullptr },
         { ConfigPathOption(), nullptr },
-        { LogPathOption(), nullptr }
+        { LogPathOption(), nullptr },
+        { InitSolutionPathOption(), nullptr }
     });
 
     for (int i = 1; i < argc; ++i) {		// skip executable name.
@@ -65,7 +71,8 @@ int Solver::Cli::run(int argc, char * argv[]) {
     pb::OilDelivery_Submission submission;
     submission.set_thread(to_string(env.jobNum));
     submission.set_instance(env.friendlyInstName());
-    submission.set_duration(to_string(solver.timer.elapsedSeconds()) + "s");
+    // the running time differs between runs, so it is left out of a reproducible output.
+    submission.set_duration(cfg.deterministic ? "" : (to_string(solver.timer.elapsedSeconds()) + "s"));
 
     solver.output.save(env.slnPath, submission);
     #if LCG_DEBUG
@@ -111,6 +118,9 @@ void Solver::Environment::load(const Map<String, char*> &optionMap) {
     str = optionMap.at(Cli::LogPathOption());
     if (str != nullptr) { logPath = str; }
 
+    str = optionMap.at(Cli::InitSolutionPathOption());
+    if (str != nullptr) { initSlnPath = str; }
+
     calibrate();
 }
 
@@ -139,23 +149,130 @@ void Solver::Environment::calibrate() {
 
 #pragma region Solver::Configuration
 void Solver::Configuration::load(const String &filePath) {
-    // EXTEND[lcg][5]: load configuration from file.
-    // EXTEND[lcg][8]: check file existence first.
+    // each row is a key and a value. missing keys keep their default values.
+    ifstream ifs(filePath);
+    if (!ifs.is_open()) { return; }
+
+    CsvReader cr;
+    const List<CsvReader::Row> &rows(cr.scan(ifs));
+    for (auto r = rows.begin(); r != rows.end(); ++r) {
+        if (r->size() < 2) { continue; }
+        String key(r->at(0));
+        const char *value = r->at(1);
+        if (key == "alg") {
+            alg = static_cast<Algorithm>(atoi(value));
+        } else if (key == "job") {
+            threadNumPerWorker = atoi(value);
+        } else if (key == "oracleCacheSize") {
+            oracleCacheSize = atoi(value);
+        } else if (key == "parallelOracleCandidateNum") {
+            parallelOracleCandidateNum = atoi(value);
+        } else if (key == "tabuTenure") {
+            tabuTenure = atoi(value);
+        } else if (key == "seenPlanNum") {
+            seenPlanNum = atoi(value);
+        } else if (key == "ejectionChainDepth") {
+            ejectionChainDepth = atoi(value);
+        } else if (key == "ejectionTrialNum") {
+            ejectionTrialNum = atoi(value);
+        } else if (key == "vndAttemptNum") {
+            vndAttemptNum = atoi(value);
+        } else if (key == "graspAlpha") {
+            graspAlpha = atof(value);
+        } else if (key == "antNum") {
+            antNum = atoi(value);
+        } else if (key == "antBeta") {
+            antBeta = atof(value);
+        } else if (key == "evaporationRate") {
+            evaporationRate = atof(value);
+        } else if (key == "relinkTimeRatio") {
+            relinkTimeRatio = atof(value);
+        } else if (key == "relinkSampleNum") {
+            relinkSampleNum = atoi(value);
+        } else if (key == "targetGap") {
+            targetGap = atof(value);
+        } else if (key == "reoptimizeTimeout") {
+            reoptimizeTimeout = atof(value);
+        } else if (key == "islandTopology") {
+            islandTopology = static_cast<Topology>(atoi(value));
+        } else if (key == "migrationInterval") {
+            migrationInterval = atof(value);
+        } else if (key == "deterministic") {
+            deterministic = (atoi(value) != 0);
+        } else if (key == "epochIterNum") {
+            epochIterNum = atoi(value);
+        } else if (key == "racing") {
+            racing = (atoi(value) != 0);
+        } else if (key == "raceSliceIterNum") {
+            raceSliceIterNum = atoi(value);
+        } else if (key == "raceMinRoundNum") {
+            raceMinRoundNum = atoi(value);
+        } else if (key == "autoConfigure") {
+            autoConfigure = (atoi(value) != 0);
+        }
+    }
 }
 
 void Solver::Configuration::save(const String &filePath) const {
-    // EXTEND[lcg][5]: save configuration to file.
+    ofstream ofs(filePath);
+    char c = CsvReader::CommaChar;
+    ofs << "alg" << c << alg << endl
+        << "job" << c << threadNumPerWorker << endl
+        << "oracleCacheSize" << c << oracleCacheSize << endl
+        << "parallelOracleCandidateNum" << c << parallelOracleCandidateNum << endl
+        << "tabuTenure" << c << tabuTenure << endl
+        << "seenPlanNum" << c << seenPlanNum << endl
+        << "ejectionChainDepth" << c << ejectionChainDepth << endl
+        << "ejectionTrialNum" << c << ejectionTrialNum << endl
+        << "vndAttemptNum" << c << vndAttemptNum << endl
+        << "graspAlpha" << c << graspAlpha << endl
+        << "antNum" << c << antNum << endl
+        << "antBeta" << c << antBeta << endl
+        << "evaporationRate" << c << evaporationRate << endl
+        << "relinkTimeRatio" << c << relinkTimeRatio << endl
+        << "relinkSampleNum" << c << relinkSampleNum << endl
+        << "targetGap" << c << targetGap << endl
+        << "reoptimizeTimeout" << c << reoptimizeTimeout << endl
+        << "islandTopology" << c << islandTopology << endl
+        << "migrationInterval" << c << migrationInterval << endl
+        << "deterministic" << c << deterministic << endl
+        << "epochIterNum" << c << epochIterNum << endl
+        << "racing" << c << racing << endl
+        << "raceSliceIterNum" << c << raceSliceIterNum << endl
+        << "raceMinRoundNum" << c << raceMinRoundNum << endl
+        << "autoConfigure" << c << autoConfigure << endl;
 }
 #pragma endregion Solver::Configuration
 
 #pragma region Solver
 bool Solver::solve() {
     init();
+    if (cfg.racing) { return runRace(); }
 
     int workerNum = (max)(1, env.jobNum / cfg.threadNumPerWorker);
     cfg.threadNumPerWorker = env.jobNum / workerNum;
     List<Solution> solutions(workerNum, Solution(this));
     List<bool> success(workerNum);
+    elitePlans.assign(workerNum, Plan());
+    migrationQueues.clear();
+    migrationQueues.resize(workerNum * workerNum);
+    for (int src = 0; src < workerNum; ++src) {
+        for (int dst = 0; dst < workerNum; ++dst) {
+            bool neighbor = (cfg.islandTopology == Configuration::Topology::Complete) && (src != dst);
+            neighbor |= (cfg.islandTopology == Configuration::Topology::Ring) && (workerNum > 1) && (dst == (src + 1) % workerNum);
+            if (neighbor) { migrationQueues[src * workerNum + dst].reset(new SpscRing<shared_ptr<const Plan>>()); }
+        }
+    }
+    nextMigrationTimes.assign(workerNum, cfg.migrationInterval);
+    seenPlans = TabuSet(cfg.seenPlanNum);
+    epochPlans.assign(2 * workerNum, nullptr);
+    epochBarrier.init(workerNum);
+    workerRands.clear();
+    for (int w = 0; w < workerNum; ++w) { workerRands.emplace_back(static_cast<int>(Hash::combine(env.randSeed, w))); }
+    if (workerNum > 1) {
+        Duration msEngineTimeout = static_cast<Duration>(env.msTimeout * (1 - cfg.relinkTimeRatio));
+        engineTimer = Timer(std::chrono::milliseconds(msEngineTimeout), timer.getStartTime());
+    }
 
     Log(LogSwitch::LCG::Framework) << "launch " << workerNum << " workers." << endl;
     List<thread> threadList;
@@ -166,6 +283,26 @@ bool Solver::solve() {
         threadList.emplace_back([&, i]() { success[i] = optimize(solutions[i], i); });
     }
     for (int i = 0; i < workerNum; ++i) { threadList.at(i).join(); }
+    // an eliminated contestant of a race is dropped, so its result is not polished.
+    if ((race != nullptr) && race->isEliminated(contestantId)) { return false; }
+    if (Cancellation::isRequested()) { Log(LogSwitch::LCG::Framework) << "cancelled at " << timer.elapsedSeconds() << "s." << endl; }
+    if (cfg.deterministic && timer.isTimeOut()) { Log(LogSwitch::LCG::Framework) << "the timeout kills the deterministic run, so the output may not be reproducible." << endl; }
+    Log(LogSwitch::LCG::Framework) << "oracle cache hits " << oracleCache.hitNum() << " times and misses " << oracleCache.missNum() << " times." << endl;
+    if (parallelOracleNum > 0) {
+        // the load balance is the mean over the max of the nodes visited by the threads of each call.
+        Log(LogSwitch::LCG::Framework) << "work stealing searched " << branchNodeNum << " nodes in " << parallelOracleNum
+            << " oracle calls with " << stealNum << " steals and load balance " << 1.0 * branchNodeNum / (max)(1LL, busiestBranchNodeNum.load()) << "." << endl;
+    }
+
+    Log(LogSwitch::LCG::Framework) << "polish the quantities of the results." << endl;
+    for (int i = 0; i < workerNum; ++i) {
+        if (!success[i]) { continue; }
+        Plan plan;
+        toPlan(solutions[i], plan);
+        if (allocateQuantities(plan) && (plan.obj > solutions[i].sumTotal + Math::DefaultTolerance * Math::DefaultTolerance)) {
+            toOutput(plan, solutions[i]);
+        }
+    }
 
     Log(LogSwitch::LCG::Framework) << "collect best result among all workers." << endl;
     int bestIndex = -1;
@@ -181,6 +318,7 @@ bool Solver::solve() {
     env.rid = to_string(bestIndex);
     if (bestIndex < 0) { return false; }
     output = solutions[bestIndex];
+    Log(LogSwitch::LCG::Framework) << "the gap to the upper bound " << bound << " is " << ((bound > 0) ? ((bound - bestValue) / bound) : 0.0) << "." << endl;
     return true;
 }
 
@@ -208,7 +346,11 @@ void Solver::record() const {
 		<< env.randSeed << ","
 		<< cfg.toBriefStr() << ","
 		<< generation << "," << iteration << ","
-		<< obj;
+		<< obj << ","
+		<< bound << "," << ((bound > 0) ? ((bound - obj) / bound) : 0.0) << ","
+		<< features.stationNum << "," << features.vehicleNum << "," << features.periodNum << ","
+		<< features.meanCabinNum << "," << features.meanCabinVolume << "," << features.cabinVolumeCv << ","
+		<< features.demandCapacityRatio << "," << features.valueDispersion << "," << features.periodValueVariance;
 
     // record solution vector.
     // EXTEND[lcg][2]: save solution in log.
@@ -221,7 +363,8 @@ void Solver::record() const {
     ofstream logFile(env.logPath, ios::app);
     logFile.seekp(0, ios::end);
     if (logFile.tellp() <= 0) {
-        logFile << "Time,ID,Instance,Feasible,ObjMatch,Width,Duration,PhysMem,VirtMem,RandSeed,Config,Generation,Iteration,Ratio,Solution" << endl;
+        logFile << "Time,ID,Instance,Feasible,ObjMatch,Width,Duration,PhysMem,VirtMem,RandSeed,Config,Generation,Iteration,Ratio,Bound,Gap,"
+            "Stations,Vehicles,Periods,CabinNum,CabinVolume,CabinVolumeCv,DemandRatio,ValueCv,PeriodValueVariance,Solution" << endl;
     }
     logFile << log.str();
     logFile.close();
@@ -257,71 +400,2340 @@ bool Solver::check(Revenue &checkerObj) const {
 }
 
 void Solver::init() {
-	periodNumber = 4;
+    // the number of periods comes from the demand list of the stations.
+    periodNumber = 0;
+    for (auto s = input.gasstations().begin(); s != input.gasstations().end(); ++s) {
+        periodNumber = (max)(periodNumber, s->demandvalues_size());
+    }
+    initInstanceData();
+    extractFeatures();
+    if (cfg.autoConfigure) { configureByFeatures(); }
+    preprocess();
+    // the cached loads of equally good oracle results depend on which worker computed them first.
+    oracleCache.init(cfg.deterministic ? 0 : cfg.oracleCacheSize);
+    bound = upperBound();
+    Log(LogSwitch::LCG::Preprocess) << "upper bound " << bound << "." << endl;
+
+    if (!env.initSlnPath.empty()) { loadInitSolution(); }
+}
+
+void Solver::initInstanceData() {
+    stationNumber = input.gasstations_size();
+    vehicleNumber = input.vehicles_size();
+
+    demands = Arr2D<int>(periodNumber, stationNumber, 0);
+    unitValues = Arr2D<double>(periodNumber, stationNumber, 0.0);
+    periodStations.assign(periodNumber, List<ID>());
+    for (ID s = 0; s < stationNumber; ++s) {
+        const auto &station(input.gasstations(s));
+        for (ID p = 0; (p < periodNumber) && (p < station.demandvalues_size()); ++p) {
+            const auto &demandValue(station.demandvalues(p));
+            if (demandValue.demand() <= 0) { continue; }
+            demands[p][s] = demandValue.demand();
+            unitValues[p][s] = 1.0 * demandValue.value() / demandValue.demand();
+            periodStations[p].push_back(s);
+        }
+    }
+    periodStationsByUnitValue = periodStations;
+    for (ID p = 0; p < periodNumber; ++p) {
+        const double *unitValue = unitValues[p];
+        stable_sort(periodStationsByUnitValue[p].begin(), periodStationsByUnitValue[p].end(),
+            [&](ID l, ID r) { return unitValue[l] > unitValue[r]; });
+    }
+
+    cabinOffsets.resize(vehicleNumber + 1);
+    cabinVolumes.clear();
+    vehicleVolumes.resize(vehicleNumber);
+    for (ID v = 0; v < vehicleNumber; ++v) {
+        cabinOffsets[v] = static_cast<ID>(cabinVolumes.size());
+        for (auto c = input.vehicles(v).cabins().begin(); c != input.vehicles(v).cabins().end(); ++c) {
+            cabinVolumes.push_back(c->volume());
+        }
+        vehicleVolumes[v] = vehicleVolume(input.vehicles(v));
+    }
+    cabinOffsets[vehicleNumber] = static_cast<ID>(cabinVolumes.size());
+    cabinNumber = cabinOffsets[vehicleNumber];
 }
 
-int Solver::vehicleVolume(const pb::OilDelivery_Vehicle& vehicle) {
+void Solver::extractFeatures() {
+    // the mean and the coefficient of variation of the samples.
+    auto meanAndCv = [](const List<double> &samples, double &mean, double &cv) {
+        mean = 0.0;
+        cv = 0.0;
+        if (samples.empty()) { return; }
+        mean = accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        double variance = 0.0;
+        for (auto x = samples.begin(); x != samples.end(); ++x) { variance += (*x - mean) * (*x - mean); }
+        variance /= samples.size();
+        if (mean > 0) { cv = sqrt(variance) / mean; }
+    };
+
+    features.stationNum = stationNumber;
+    features.vehicleNum = vehicleNumber;
+    features.periodNum = periodNumber;
+    features.meanCabinNum = 1.0 * cabinNumber / (max)(vehicleNumber, 1);
+    meanAndCv(List<double>(cabinVolumes.begin(), cabinVolumes.end()), features.meanCabinVolume, features.cabinVolumeCv);
+
+    double capacity = accumulate(vehicleVolumes.begin(), vehicleVolumes.end(), 0.0);
+    double demandRatioSum = 0.0;
+    List<double> periodValues(periodNumber, 0.0);
+    List<double> unitValueSamples;
+    for (ID p = 0; p < periodNumber; ++p) {
+        double demand = 0.0;
+        for (auto s = periodStations[p].begin(); s != periodStations[p].end(); ++s) {
+            demand += demands[p][*s];
+            periodValues[p] += demands[p][*s] * unitValues[p][*s];
+            unitValueSamples.push_back(unitValues[p][*s]);
+        }
+        if (capacity > 0) { demandRatioSum += demand / capacity; }
+    }
+    features.demandCapacityRatio = demandRatioSum / (max)(periodNumber, 1);
+    double meanUnitValue;
+    meanAndCv(unitValueSamples, meanUnitValue, features.valueDispersion);
+    double meanPeriodValue;
+    double periodValueCv;
+    meanAndCv(periodValues, meanPeriodValue, periodValueCv);
+    features.periodValueVariance = periodValueCv * periodValueCv;
+
+    Log(LogSwitch::LCG::Preprocess) << features.stationNum << " stations, " << features.vehicleNum << " vehicles with "
+        << features.meanCabinNum << " cabins of " << features.meanCabinVolume << " (cv " << features.cabinVolumeCv << "), demand/capacity "
+        << features.demandCapacityRatio << ", value cv " << features.valueDispersion << ", period value variance " << features.periodValueVariance << "." << endl;
+}
+
+void Solver::configureByFeatures() {
+    // fit on 5 second runs of the engines on 18 instances from 12 to 14000 vehicle-periods, including generated
+    // ones with loose demands, flat or skewed unit values and 12 periods. the features go to log.csv for refits.
+    // - the iterated local search led fix-and-optimize by 1% to 10% up to 800 vehicle-periods,
+    //   which turned over at 1600 (132.0k against 131.5k) and 14000 (685k against 680k).
+    // - grasp led the others by 17% on the loose instances where the demand of a period fits into
+    //   the vehicles (demand/capacity 0.8 to 1.0), except on the smallest one (48 vehicle-periods).
+    // - 2 starts of vnd did as well as 8 in fix-and-optimize on the large instances.
+    // - the winner did not change with the unit value dispersion, the period value variance or the cabins.
+    constexpr ID SmallVehiclePeriodNum = 64;
+    constexpr ID LargeVehiclePeriodNum = 1000;
+    constexpr double LooseDemandCapacityRatio = 2.0;
+
+    ID vehiclePeriodNum = features.vehicleNum * features.periodNum;
+    if (features.demandCapacityRatio < LooseDemandCapacityRatio) {
+        cfg.alg = (vehiclePeriodNum <= SmallVehiclePeriodNum)
+            ? Configuration::Algorithm::LocalSearch
+            : Configuration::Algorithm::Grasp;
+    } else if (vehiclePeriodNum <= LargeVehiclePeriodNum) {
+        cfg.alg = Configuration::Algorithm::LocalSearch;
+    } else {
+        cfg.alg = Configuration::Algorithm::MathematicallProgramming;
+        cfg.vndAttemptNum = 2;
+    }
+    Log(LogSwitch::LCG::Preprocess) << "configure alg=" << cfg.alg << " and vndAttemptNum=" << cfg.vndAttemptNum << " by the features." << endl;
+}
+
+void Solver::preprocess() {
+    // drop the stations which earn nothing in any period from the candidate lists.
+    // they could only raise the full load rate of a vehicle at the cost of its load sharing.
+    List<bool> worthless(stationNumber, true);
+    for (ID p = 0; p < periodNumber; ++p) {
+        for (auto s = periodStations[p].begin(); s != periodStations[p].end(); ++s) {
+            if (unitValues[p][*s] > 0) { worthless[*s] = false; }
+        }
+    }
+    ID worthlessNum = 0;
+    for (ID p = 0; p < periodNumber; ++p) {
+        auto isWorthless = [&](ID s) { return worthless[s]; };
+        periodStations[p].erase(remove_if(periodStations[p].begin(), periodStations[p].end(), isWorthless), periodStations[p].end());
+        periodStationsByUnitValue[p].erase(remove_if(periodStationsByUnitValue[p].begin(), periodStationsByUnitValue[p].end(), isWorthless), periodStationsByUnitValue[p].end());
+    }
+    for (ID s = 0; s < stationNumber; ++s) { if (worthless[s]) { ++worthlessNum; } }
+    candidateStations.assign(periodNumber, Bitset(stationNumber));
+    for (ID p = 0; p < periodNumber; ++p) {
+        for (auto s = periodStations[p].begin(); s != periodStations[p].end(); ++s) { candidateStations[p].set(*s); }
+    }
+
+    // no dominance between stations is detected, since a vehicle visits a window of consecutive station ids,
+    // where a station with more demand and unit value in every period does not stand in for another.
+
+    // rank the periods of each station by the value of meeting all demand.
+    periodRankings = Arr2D<ID>(stationNumber, periodNumber);
+    for (ID s = 0; s < stationNumber; ++s) {
+        ID *ranking = periodRankings[s];
+        for (ID p = 0; p < periodNumber; ++p) { ranking[p] = p; }
+        stable_sort(ranking, ranking + periodNumber, [&](ID l, ID r) {
+            return demands[l][s] * unitValues[l][s] > demands[r][s] * unitValues[r][s];
+        });
+    }
+
+    // identical cabins have the same volume and they are adjacent in the decreasing volume order.
+    cabinOrders.resize(cabinNumber);
+    for (ID v = 0; v < vehicleNumber; ++v) {
+        ID *order = cabinOrders.data() + cabinOffsets[v];
+        const int *volumes = cabinVolumes.data() + cabinOffsets[v];
+        for (ID c = 0; c < cabinNumberOf(v); ++c) { order[c] = c; }
+        stable_sort(order, order + cabinNumberOf(v), [&](ID l, ID r) { return volumes[l] > volumes[r]; });
+    }
+
+    // identical vehicles have the same sorted cabin volumes.
+    Map<List<int>, ID> vehicleClassIds;
+    vehicleClasses.resize(vehicleNumber);
+    for (ID v = 0; v < vehicleNumber; ++v) {
+        List<int> volumes(cabinNumberOf(v));
+        for (ID c = 0; c < cabinNumberOf(v); ++c) { volumes[c] = cabinVolumes[cabinOffsets[v] + cabinOrders[cabinOffsets[v] + c]]; }
+        auto iter = vehicleClassIds.insert({ volumes, static_cast<ID>(vehicleClassIds.size()) }).first;
+        vehicleClasses[v] = iter->second;
+    }
+    vehicleClassNumber = static_cast<ID>(vehicleClassIds.size());
+
+    Log(LogSwitch::LCG::Preprocess) << "drop " << worthlessNum << " worthless stations and detect "
+        << vehicleClassNumber << " vehicle classes." << endl;
+}
+
+void Solver::loadInitSolution() {
+    Log(LogSwitch::LCG::Input) << "load initial solution " << env.initSlnPath << "." << endl;
+    if (!initSln.load(env.initSlnPath)) {
+        Log(LogSwitch::LCG::Input) << "fail to read the initial solution. start from scratch." << endl;
+        initSln.Clear();
+        return;
+    }
+
+    repair(initSln);
+    Log(LogSwitch::LCG::Preprocess) << "repaired initial solution got " << initSln.sumTotal << endl;
+}
+
+Revenue Solver::upperBound() const {
+    static mutex boundMutex;
+    static Map<Hash::Key, Revenue> bounds;
+
+    Hash::Key key = instanceHash();
+    {
+        lock_guard<mutex> boundGuard(boundMutex);
+        auto b = bounds.find(key);
+        if (b != bounds.end()) { return b->second; }
+    }
+    Revenue newBound = relaxationBound();
+    lock_guard<mutex> boundGuard(boundMutex);
+    return bounds.insert({ key, newBound }).first->second;
+}
+
+Revenue Solver::relaxationBound() const {
+    // the value of a vehicle-period is no more than the value of its loads, as the load rate and the span
+    // factor are at most 1. relax the stations to be split among the periods and the vehicles of a period
+    // to be one tank with the total volume. the lagrangian dual of the capacity of each period is then
+    // separable by station, and the multipliers are set by exact coordinate descent.
+    double capacity = accumulate(vehicleVolumes.begin(), vehicleVolumes.end(), 0.0);
+    List<double> prices(periodNumber, 0.0);
+    auto dualValue = [&]() {
+        double value = capacity * accumulate(prices.begin(), prices.end(), 0.0);
+        for (ID s = 0; s < stationNumber; ++s) {
+            double best = 0.0;
+            for (ID p = 0; p < periodNumber; ++p) { best = (max)(best, demands[p][s] * (unitValues[p][s] - prices[p])); }
+            value += best;
+        }
+        return value;
+    };
+
+    // the dual restricted to prices[p] is convex and piecewise linear. its slope is the capacity minus the
+    // demand of the stations still preferring period p, which shrinks as prices[p] passes their thresholds.
+    struct Threshold {
+        double price;
+        int demand;
+    };
+    List<Threshold> thresholds;
+    thresholds.reserve(stationNumber);
+    constexpr int MaxRoundNum = 100;
+    double bestValue = dualValue();
+    for (int round = 0; round < MaxRoundNum; ++round) {
+        for (ID p = 0; p < periodNumber; ++p) {
+            thresholds.clear();
+            for (auto s = periodStations[p].begin(); s != periodStations[p].end(); ++s) {
+                double other = 0.0;
+                for (ID q = 0; q < periodNumber; ++q) {
+                    if (q != p) { other = (max)(other, demands[q][*s] * (unitValues[q][*s] - prices[q])); }
+                }
+                double price = unitValues[p][*s] - other / demands[p][*s];
+                if (price > 0) { thresholds.push_back({ price, demands[p][*s] }); }
+            }
+            sort(thresholds.begin(), thresholds.end(), [](const Threshold &l, const Threshold &r) { return l.price > r.price; });
+            prices[p] = 0.0;
+            double demand = 0.0;
+            for (auto t = thresholds.begin(); t != thresholds.end(); ++t) {
+                if ((demand += t->demand) <= capacity) { continue; }
+                prices[p] = t->price;
+                break;
+            }
+        }
+        // every multiplier gives a valid bound, and the descent stops once it stalls.
+        double value = dualValue();
+        bool stalled = (value >= bestValue - Math::DefaultTolerance);
+        bestValue = (min)(bestValue, value);
+        if (stalled) { break; }
+    }
+    return bestValue;
+}
+
+Hash::Key Solver::instanceHash() const {
+    Hash::Key key = Hash::combine(periodNumber, stationNumber);
+    for (ID p = 0; p < periodNumber; ++p) {
+        for (ID s = 0; s < stationNumber; ++s) {
+            key = Hash::combine(Hash::combine(key, demands[p][s]), llround(demands[p][s] * unitValues[p][s]));
+        }
+    }
+    key = Hash::combine(key, vehicleNumber);
+    for (ID v = 0; v < vehicleNumber; ++v) {
+        key = Hash::combine(key, cabinNumberOf(v));
+        for (ID c = 0; c < cabinNumberOf(v); ++c) { key = Hash::combine(key, cabinVolumes[cabinOffsets[v] + c]); }
+    }
+    return key;
+}
+
+void Solver::reportObjective(Revenue obj) {
+    // the gap is checked at the end of each epoch in deterministic mode.
+    if (cfg.deterministic) { return; }
+    if (bound - obj <= cfg.targetGap * bound) { stopped = true; }
+}
+
+int Solver::vehicleVolume(const pb::OilDelivery_Vehicle& vehicle) const {
 	int volume = 0;
 	for (auto cabin : vehicle.cabins()) { volume += cabin.volume(); }
 	return volume;
 }
 
+Revenue Solver::evaluate(const Problem::Output &sln) const {
+    Revenue obj = 0.0;
+    for (ID p = 0; p < sln.deliveries_size(); ++p) {
+        for (auto vd = sln.deliveries(p).vehicledeliveries().begin(); vd != sln.deliveries(p).vehicledeliveries().end(); ++vd) {
+            const auto &vehicle(input.vehicles(vd->id()));
+            double vehicleValue = 0.0;
+            int vehicleLoad = 0;
+            ID maxStationId = Problem::InvalidId;
+            ID minStationId = input.gasstations_size();
+            for (auto cd = vd->cabindeliveries().begin(); cd != vd->cabindeliveries().end(); ++cd) {
+                const auto &demandValue(input.gasstations(cd->stationid()).demandvalues(p));
+                vehicleValue += 1.0 * cd->quantity() * demandValue.value() / demandValue.demand();
+                vehicleLoad += cd->quantity();
+                maxStationId = (max)(maxStationId, cd->stationid());
+                minStationId = (min)(minStationId, cd->stationid());
+            }
+            if (vehicleLoad <= 0) { continue; }
+
+            double fullLoadRate = 1.0 * vehicleLoad / vehicleVolume(vehicle);
+            double loadSharing = 1.0 * vehicle.cabins_size() / (vehicle.cabins_size() + maxStationId - minStationId);
+            obj += vehicleValue * fullLoadRate * loadSharing;
+        }
+    }
+    return obj;
+}
+
+void Solver::repair(Problem::Output &sln) const {
+    struct CabinLoad {
+        ID cabin;
+        ID station;
+        int quantity;
+    };
+
+    ID stationNumber = input.gasstations_size();
+    ID vehicleNumber = input.vehicles_size();
+
+    long long slnQuantity = 0;
+    for (auto d = sln.deliveries().begin(); d != sln.deliveries().end(); ++d) {
+        for (auto vd = d->vehicledeliveries().begin(); vd != d->vehicledeliveries().end(); ++vd) {
+            for (auto cd = vd->cabindeliveries().begin(); cd != vd->cabindeliveries().end(); ++cd) { slnQuantity += (max)(0, cd->quantity()); }
+        }
+    }
+
+    // keep the first delivery of each known vehicle and cabin, and fit quantities to cabin volumes.
+    List<List<List<CabinLoad>>> plan(periodNumber, List<List<CabinLoad>>(vehicleNumber));
+    List<double> deliveredValue(stationNumber * periodNumber, 0.0);
+    for (ID p = 0; (p < periodNumber) && (p < sln.deliveries_size()); ++p) {
+        List<bool> vehicleDispatched(vehicleNumber, false);
+        for (auto vd = sln.deliveries(p).vehicledeliveries().begin(); vd != sln.deliveries(p).vehicledeliveries().end(); ++vd) {
+            ID v = vd->id();
+            if ((v < 0) || (v >= vehicleNumber) || vehicleDispatched[v]) { continue; }
+            vehicleDispatched[v] = true;
+
+            const auto &vehicle(input.vehicles(v));
+            List<bool> cabinLoaded(vehicle.cabins_size(), false);
+            for (auto cd = vd->cabindeliveries().begin(); cd != vd->cabindeliveries().end(); ++cd) {
+                ID c = cd->id();
+                ID s = cd->stationid();
+                if ((c < 0) || (c >= vehicle.cabins_size()) || cabinLoaded[c]) { continue; }
+                if ((s < 0) || (s >= stationNumber) || (p >= input.gasstations(s).demandvalues_size())) { continue; }
+                const auto &demandValue(input.gasstations(s).demandvalues(p));
+                int quantity = (min)(cd->quantity(), vehicle.cabins(c).volume());
+                if ((quantity <= 0) || (demandValue.demand() <= 0)) { continue; }
+
+                cabinLoaded[c] = true;
+                plan[p][v].push_back({ c, s, quantity });
+                deliveredValue[s * periodNumber + p] += 1.0 * quantity * demandValue.value() / demandValue.demand();
+            }
+        }
+    }
+
+    // each station keeps the period where it receives the most value.
+    List<ID> stationPeriod(stationNumber, Problem::InvalidId);
+    for (ID s = 0; s < stationNumber; ++s) {
+        double bestValue = -1.0;
+        for (ID p = 0; p < periodNumber; ++p) {
+            if (deliveredValue[s * periodNumber + p] <= bestValue) { continue; }
+            bestValue = deliveredValue[s * periodNumber + p];
+            stationPeriod[s] = p;
+        }
+    }
+
+    // the cabins loading an overflowed station share its demand by a transportation problem, where a unit in
+    // a cabin is worth the marginal value of its vehicle. a station with too many holders is cut below.
+    struct Holder {
+        ID vehicle;
+        ID load; // the index in plan[p][vehicle].
+    };
+    Map<ID, List<Holder>> holders;
+    List<std::pair<Holder, int>> arcs; // the holder of each arc in the current batch.
+    List<double> vehicleValues(vehicleNumber);
+    List<int> vehicleLoads(vehicleNumber);
+    List<double> valueRates(vehicleNumber); // the load sharing over the volume of each vehicle.
+    for (ID p = 0; p < periodNumber; ++p) {
+        holders.clear();
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            vehicleValues[v] = 0.0;
+            vehicleLoads[v] = 0;
+            ID minStationId = stationNumber;
+            ID maxStationId = Problem::InvalidId;
+            for (size_t l = 0; l < plan[p][v].size(); ++l) {
+                const CabinLoad &load(plan[p][v][l]);
+                if (stationPeriod[load.station] != p) { continue; }
+                vehicleValues[v] += load.quantity * unitValues[p][load.station];
+                vehicleLoads[v] += load.quantity;
+                minStationId = (min)(minStationId, load.station);
+                maxStationId = (max)(maxStationId, load.station);
+                holders[load.station].push_back({ v, static_cast<ID>(l) });
+            }
+            ID k = cabinNumberOf(v);
+            valueRates[v] = (maxStationId < 0) ? 0.0 : (1.0 * k / (k + maxStationId - minStationId) / vehicleVolumes[v]);
+        }
+
+        ID nodeNum = 2; // the source and the sink.
+        transportation.clear(MaxSplitArcNum + 2);
+        auto solveBatch = [&]() {
+            transportation.solve(0, 1);
+            for (auto a = arcs.begin(); a != arcs.end(); ++a) {
+                plan[p][a->first.vehicle][a->first.load].quantity = transportation.flowOn(a->second);
+            }
+            arcs.clear();
+            nodeNum = 2;
+            transportation.clear(MaxSplitArcNum + 2);
+        };
+        for (auto h = holders.begin(); h != holders.end(); ++h) {
+            int quantity = 0;
+            for (auto c = h->second.begin(); c != h->second.end(); ++c) { quantity += plan[p][c->vehicle][c->load].quantity; }
+            if ((h->second.size() < 2) || (quantity <= demands[p][h->first])) { continue; }
+            if (h->second.size() + 1 > MaxSplitArcNum) { continue; }
+            if (transportation.full(static_cast<int>(h->second.size()) + 1)) { solveBatch(); }
+            ID station = nodeNum++;
+            transportation.addArc(0, station, demands[p][h->first], 0.0);
+            for (auto c = h->second.begin(); c != h->second.end(); ++c) {
+                double gain = (unitValues[p][h->first] * vehicleLoads[c->vehicle] + vehicleValues[c->vehicle]) * valueRates[c->vehicle];
+                arcs.push_back({ *c, transportation.addArc(station, 1, plan[p][c->vehicle][c->load].quantity, -gain) });
+            }
+        }
+        if (!arcs.empty()) { solveBatch(); }
+    }
+
+    // cut the overflowed quantities in the order of vehicles and cabins.
+    sln.Clear();
+    long long keptQuantity = 0;
+    List<int> restDemand(stationNumber);
+    for (ID p = 0; p < periodNumber; ++p) {
+        for (ID s = 0; s < stationNumber; ++s) {
+            const auto &station(input.gasstations(s));
+            restDemand[s] = (p < station.demandvalues_size()) ? station.demandvalues(p).demand() : 0;
+        }
+
+        auto &delivery(*sln.add_deliveries());
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            auto &vd(*delivery.add_vehicledeliveries());
+            vd.set_id(v);
+            for (auto l = plan[p][v].begin(); l != plan[p][v].end(); ++l) {
+                if (stationPeriod[l->station] != p) { continue; }
+                int quantity = (min)(l->quantity, restDemand[l->station]);
+                if (quantity <= 0) { continue; }
+                restDemand[l->station] -= quantity;
+                keptQuantity += quantity;
+
+                auto &cd(*vd.add_cabindeliveries());
+                cd.set_id(l->cabin);
+                cd.set_stationid(l->station);
+                cd.set_quantity(quantity);
+            }
+        }
+    }
+
+    sln.sumTotal = evaluate(sln);
+
+    // a solution of another instance loses most of its quantities.
+    if (keptQuantity * 2 < slnQuantity) {
+        Log(LogSwitch::LCG::Input) << "the repair drops or cuts " << (slnQuantity - keptQuantity) << " of "
+            << slnQuantity << " units. the solution may be of another instance." << endl;
+    }
+}
+
 bool Solver::optimize(Solution &sln, ID workerId) {
 	Log(LogSwitch::LCG::Framework) << "worker " << workerId << " starts." << endl;
 
-	ID stationNumber = input.gasstations_size();
-	ID vehicleNumber = input.vehicles_size();
-
-	bool status = true;
-	auto &deliveries(*sln.mutable_deliveries());
-	deliveries.Reserve(periodNumber);
-	sln.sumTotal = 0.0;
-
-	// TODO[0]: replace the following random assignment with your own algorithm.
-	for (int i = 0; !timer.isTimeOut() && (i < periodNumber); ++i) {
-		auto &delivery(*sln.add_deliveries());
-
-		for (ID v = 0; v < vehicleNumber;++v) {
-			auto vehicle = delivery.add_vehicledeliveries();
-			ID cabinNumber = input.vehicles(v).cabins_size();
-			// intermediate variables to count objective `sumTotal`
-			double vehicleValue = 0.0, fullLoadRate = 0.0, loadSharing = 0.0;
-			int vehicleLoad = 0, maxStationId = 0, minStationId = 0;
-
-			vehicle->set_id(v);
-			for (ID c = 0; c < cabinNumber;++c ) {
-				auto cabinInput = input.vehicles(v).cabins(c);
-				auto cabin = vehicle->add_cabindeliveries();
-				cabin->set_id(c);
-				int stationId = rand.pick(0, stationNumber);
-				int demand = input.gasstations(stationId).demandvalues(i).demand();
-				int value = input.gasstations(stationId).demandvalues(i).value();
-				int maxQuantity = cabinInput.volume() > demand ? demand : cabinInput.volume();
-				int quantity = rand.pick(0, maxQuantity + 1);
-				cabin->set_stationid(stationId);
-				cabin->set_quantity(quantity);
-
-
-				// total value loaded by a vehicle
-				vehicleValue += 1.0*quantity * value / demand;
-				// loadage of a vehicle
-				vehicleLoad += quantity;
-				// max and min station id
-				if (stationId > maxStationId) { maxStationId = stationId; }
-				if (stationId < minStationId) { minStationId = stationId; }
-			}
-			// full load rate
-			fullLoadRate = 1.0*vehicleLoad / vehicleVolume(input.vehicles(v));
-			// load sharing
-			
-			loadSharing = 1.0*cabinNumber / (cabinNumber + maxStationId - minStationId);
-			// sum value of all vehicles in all periods
-			sln.sumTotal += vehicleValue * fullLoadRate * loadSharing;
-		}
-	}
+    Plan plan;
+    if (initSln.deliveries_size() > 0) {
+        Log(LogSwitch::LCG::Framework) << "worker " << workerId << " starts from the initial solution." << endl;
+        toPlan(initSln, plan);
+    } else {
+        initPlan(plan);
+    }
+
+    switch (cfg.alg) {
+    case Configuration::Algorithm::Grasp:
+        grasp(plan, workerId); break;
+    case Configuration::Algorithm::AntColony:
+        antColony(plan, workerId); break;
+    case Configuration::Algorithm::MathematicallProgramming:
+        fixAndOptimize(plan, workerId); break;
+    default:
+        iteratedLocalSearch(plan, workerId); break;
+    }
+    if (elitePlans.size() > 1) { relinkElites(plan, workerId); }
+    toOutput(plan, sln);
 
 	Log(LogSwitch::LCG::Framework) << "worker " << workerId << " ends." << endl;
-	return status;
+	return true;
+}
+
+void Solver::iteratedLocalSearch(Plan &plan, ID workerId) {
+    Random &rng(workerRands[workerId]);
+
+    // the first pass on an empty plan is a randomized greedy construction.
+    variableNeighborhoodDescent(plan, rng);
+    reportObjective(plan.obj);
+
+    // iterated local search. rebuild part of a period and widen the ruin on revisited local optima.
+    Plan bestPlan(plan);
+    TabuSet tabu(cfg.tabuTenure);
+    tabu.insert(plan.hash);
+    markSeen(plan.hash);
+    ID ruinSize = 1;
+    Iteration iter = 0;
+    Iteration duplicateNum = 0;
+    for (; !isEngineStopped() && (iter < env.maxIter); ++iter) {
+        if (migrate(bestPlan, workerId, iter)) { plan = bestPlan; }
+        perturb(plan, ruinSize, rng);
+        variableNeighborhoodDescent(plan, rng);
+
+        if (tabu.insert(plan.hash) && markSeen(plan.hash)) {
+            ruinSize = 1;
+        } else {
+            ++duplicateNum;
+            ruinSize = (min)(2 * ruinSize, vehicleNumber);
+        }
+        if (plan.obj > bestPlan.obj + Math::DefaultTolerance * Math::DefaultTolerance) {
+            bestPlan = plan;
+            reportObjective(bestPlan.obj);
+        } else {
+            plan = bestPlan;
+        }
+    }
+    Log(LogSwitch::LCG::Framework) << "worker " << workerId << " reaches " << iter << " local optima with "
+        << duplicateNum << " duplicates." << endl;
+    plan = bestPlan;
+}
+
+void Solver::grasp(Plan &plan, ID workerId) {
+    // every worker runs its own stream of starts. the warm start is the first incumbent if any.
+    Random &rng(workerRands[workerId]);
+    Plan bestPlan(plan);
+    Iteration iter = 0;
+    for (; (iter == 0) || (!isEngineStopped() && (iter < env.maxIter)); ++iter) {
+        migrate(bestPlan, workerId, iter);
+        initPlan(plan);
+        constructGreedily(plan, cfg.graspAlpha, rng);
+        variableNeighborhoodDescent(plan, rng);
+        if (plan.obj > bestPlan.obj + Math::DefaultTolerance * Math::DefaultTolerance) {
+            bestPlan = plan;
+            reportObjective(bestPlan.obj);
+        }
+    }
+    Log(LogSwitch::LCG::Framework) << "worker " << workerId << " makes " << iter << " greedy randomized starts." << endl;
+    plan = bestPlan;
+}
+
+bool Solver::migrate(Plan &bestPlan, ID workerId, Iteration iter) {
+    // a contestant gives up its thread to the other contestants every cfg.raceSliceIterNum iterations.
+    if ((race != nullptr) && (iter > 0) && (iter % cfg.raceSliceIterNum == 0)) {
+        if (!race->yield(contestantId, bestPlan.obj)) { stopped = true; }
+    }
+
+    if (cfg.deterministic) {
+        if ((iter == 0) || (iter % cfg.epochIterNum != 0)) { return false; }
+        return synchronize(bestPlan, workerId, iter / cfg.epochIterNum);
+    }
+
+    if (timer.elapsedSeconds() < nextMigrationTimes[workerId]) { return false; }
+    nextMigrationTimes[workerId] = timer.elapsedSeconds() + cfg.migrationInterval;
+
+    // the emigrant is shared by all neighbors. it is dropped by the neighbors whose queues are full.
+    ID workerNum = static_cast<ID>(elitePlans.size());
+    shared_ptr<const Plan> emigrant;
+    for (ID w = 0; w < workerNum; ++w) {
+        auto &queue(migrationQueues[workerId * workerNum + w]);
+        if (!queue) { continue; }
+        if (!emigrant) { emigrant = make_shared<const Plan>(bestPlan); }
+        queue->push(emigrant);
+    }
+
+    shared_ptr<const Plan> immigrant;
+    shared_ptr<const Plan> bestImmigrant;
+    for (ID w = 0; w < workerNum; ++w) {
+        auto &queue(migrationQueues[w * workerNum + workerId]);
+        if (!queue) { continue; }
+        while (queue->pop(immigrant)) {
+            if (!bestImmigrant || (immigrant->obj > bestImmigrant->obj)) { bestImmigrant = immigrant; }
+        }
+    }
+    if (!bestImmigrant || (bestImmigrant->obj <= bestPlan.obj + Math::DefaultTolerance * Math::DefaultTolerance)) { return false; }
+    Log(LogSwitch::LCG::Framework) << "worker " << workerId << " adopts an immigrant of " << bestImmigrant->obj << "." << endl;
+    bestPlan = *bestImmigrant;
+    return true;
+}
+
+bool Solver::synchronize(Plan &bestPlan, ID workerId, Iteration epoch) {
+    // a worker may start the next epoch while the others are still reading the plans of this one.
+    ID workerNum = static_cast<ID>(elitePlans.size());
+    shared_ptr<const Plan> *plans = epochPlans.data() + (epoch % 2) * workerNum;
+    plans[workerId] = make_shared<const Plan>(bestPlan);
+
+    // the last arriving worker decides for all of them, so that they stop after the same epoch.
+    // the timer is left out of the decision. a timeout kills the workers in the middle of the epoch,
+    // and the killed workers never arrive.
+    bool synchronized = epochBarrier.arriveAndWait([&]() {
+        Revenue bestObj = 0.0;
+        for (ID w = 0; w < workerNum; ++w) { bestObj = (max)(bestObj, plans[w]->obj); }
+        if (bound - bestObj <= cfg.targetGap * bound) { stopped = true; }
+    }, [&]() { return timer.isTimeOut(); });
+    // on cancellation or timeout, the plans of the workers which have not arrived are missing or being written.
+    if (!synchronized) {
+        stopped = true;
+        return false;
+    }
+
+    shared_ptr<const Plan> bestImmigrant;
+    for (ID w = 0; w < workerNum; ++w) {
+        if (!migrationQueues[w * workerNum + workerId]) { continue; }
+        if (!bestImmigrant || (plans[w]->obj > bestImmigrant->obj)) { bestImmigrant = plans[w]; }
+    }
+    if (!bestImmigrant || (bestImmigrant->obj <= bestPlan.obj + Math::DefaultTolerance * Math::DefaultTolerance)) { return false; }
+    bestPlan = *bestImmigrant;
+    return true;
+}
+
+bool Solver::runRace() {
+    List<Configuration> cfgs;
+    raceConfigurations(cfgs);
+    int contestantNum = static_cast<int>(cfgs.size());
+    Race contest(contestantNum, (max)(1, env.jobNum), cfg.raceMinRoundNum);
+
+    // the contestants share the deadline of this solver but draw from their own random streams.
+    Environment contestantEnv(env);
+    contestantEnv.jobNum = 1;
+    List<unique_ptr<Solver>> contestants;
+    contestants.reserve(contestantNum);
+    for (int c = 0; c < contestantNum; ++c) {
+        contestantEnv.randSeed = static_cast<int>(Hash::combine(env.randSeed, c));
+        contestants.emplace_back(new Solver(input, contestantEnv, cfgs[c]));
+        contestants.back()->timer = timer;
+        contestants.back()->engineTimer = timer;
+        contestants.back()->race = &contest;
+        contestants.back()->contestantId = c;
+    }
+
+    Log(LogSwitch::LCG::Framework) << "race " << contestantNum << " configurations on " << env.jobNum << " threads." << endl;
+    List<thread> threadList;
+    threadList.reserve(contestantNum);
+    for (int c = 0; c < contestantNum; ++c) {
+        threadList.emplace_back([&, c]() {
+            // the contestants not started before the deadline are left out instead of being rushed.
+            contest.start(c);
+            if (!contestants[c]->isStopped()) { contestants[c]->solve(); }
+            contest.finish(c);
+        });
+    }
+    contest.run([&]() { return isStopped(); });
+    for (auto t = threadList.begin(); t != threadList.end(); ++t) { t->join(); }
+
+    int bestIndex = -1;
+    Revenue bestValue = 0.0;
+    for (int c = 0; c < contestantNum; ++c) {
+        Revenue value = contestants[c]->output.sumTotal;
+        bool eliminated = contest.isEliminated(c);
+        Log(LogSwitch::LCG::Framework) << "contestant " << c << " (" << cfgs[c].toBriefStr() << ") got " << value
+            << (eliminated ? " before elimination." : ".") << endl;
+        if (eliminated || (value <= bestValue)) { continue; }
+        bestIndex = c;
+        bestValue = value;
+    }
+    Log(LogSwitch::LCG::Framework) << "the race is decided after " << contest.roundNumber() << " rounds." << endl;
+
+    env.rid = to_string(bestIndex);
+    if (bestIndex < 0) { return false; }
+    output = contestants[bestIndex]->output;
+    Log(LogSwitch::LCG::Framework) << "the gap to the upper bound " << bound << " is " << ((bound > 0) ? ((bound - bestValue) / bound) : 0.0) << "." << endl;
+    return true;
+}
+
+void Solver::raceConfigurations(List<Configuration> &cfgs) const {
+    Configuration base(cfg);
+    base.racing = false;
+    base.autoConfigure = false;
+    base.deterministic = false;
+    base.threadNumPerWorker = 1;
+    base.islandTopology = Configuration::Topology::Isolated;
+
+    cfgs.clear();
+    Configuration c(base);
+    c.alg = Configuration::Algorithm::LocalSearch;
+    for (int tenure : { 16, 64, 256 }) {
+        for (int attemptNum : { 2, 4, 8 }) {
+            c.tabuTenure = tenure;
+            c.vndAttemptNum = attemptNum;
+            cfgs.push_back(c);
+        }
+    }
+    c = base;
+    c.alg = Configuration::Algorithm::Grasp;
+    for (double alpha : { 0.1, 0.3, 0.5 }) {
+        c.graspAlpha = alpha;
+        cfgs.push_back(c);
+    }
+    c = base;
+    c.alg = Configuration::Algorithm::AntColony;
+    for (double beta : { 1.0, 2.0, 4.0 }) {
+        for (double rate : { 0.05, 0.2 }) {
+            c.antBeta = beta;
+            c.evaporationRate = rate;
+            cfgs.push_back(c);
+        }
+    }
+    c = base;
+    c.alg = Configuration::Algorithm::MathematicallProgramming;
+    for (int attemptNum : { 2, 4, 8 }) {
+        c.vndAttemptNum = attemptNum;
+        cfgs.push_back(c);
+    }
+}
+
+void Solver::relinkElites(Plan &plan, ID workerId) {
+    {
+        lock_guard<mutex> elitePlanGuard(elitePlanMutex);
+        elitePlans[workerId] = plan;
+    }
+
+    // the workers finish their engines at about the same time, so wait for the rest a little. the guides are
+    // taken in increasing worker id for reproducibility. the elite plans are never modified once published,
+    // so they can be read without the lock.
+    Iteration relinkNum = 0;
+    Iteration improvementNum = 0;
+    for (ID guide = 0; !isStopped() && (guide < static_cast<ID>(elitePlans.size()));) {
+        bool ready;
+        {
+            lock_guard<mutex> elitePlanGuard(elitePlanMutex);
+            ready = !elitePlans[guide].loads.empty();
+        }
+        if (!ready) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+            continue;
+        }
+        if ((guide != workerId) && (elitePlans[guide].hash != plan.hash)) {
+            ++relinkNum;
+            if (relinkPath(plan, elitePlans[guide], workerRands[workerId])) { ++improvementNum; }
+        }
+        ++guide;
+    }
+    Log(LogSwitch::LCG::Framework) << "worker " << workerId << " relinks " << relinkNum << " paths with "
+        << improvementNum << " improvements." << endl;
+}
+
+bool Solver::relinkPath(Plan &plan, const Plan &guide, Random &rng) {
+    // the vehicle-periods with different loads in the two plans.
+    List<ID> differences;
+    auto differs = [&](const Plan &path, ID i) {
+        ID p = i / vehicleNumber;
+        ID v = i % vehicleNumber;
+        const Plan::CabinLoad *l = path.loads.data() + loadIndex(p, v);
+        const Plan::CabinLoad *r = guide.loads.data() + loadIndex(p, v);
+        for (ID c = 0; c < cabinNumberOf(v); ++c) {
+            if ((l[c].quantity != r[c].quantity) || ((l[c].quantity > 0) && (l[c].station != r[c].station))) { return true; }
+        }
+        return false;
+    };
+    for (ID i = 0; i < periodNumber * vehicleNumber; ++i) {
+        if (differs(plan, i)) { differences.push_back(i); }
+    }
+
+    // copy the loads of the guide to a vehicle-period. the station is taken away from the other periods
+    // and the quantities are cut to the residual demands, so that every intermediate plan is feasible.
+    List<Plan::CabinLoad> loads;
+    auto copyLoads = [&](Plan &path, ID i, List<LoadChange> &changes) {
+        ID p = i / vehicleNumber;
+        ID v = i % vehicleNumber;
+        const Plan::CabinLoad *guideLoads = guide.loads.data() + loadIndex(p, v);
+        loads.assign(cabinNumberOf(v), Plan::CabinLoad());
+        assign(path, p, v, loads, changes);
+        for (ID c = 0; c < cabinNumberOf(v); ++c) {
+            if (guideLoads[c].quantity <= 0) { continue; }
+            ID s = guideLoads[c].station;
+            ID q = path.stationPeriods[s];
+            if ((q != Problem::InvalidId) && (q != p)) { releaseStation(path, q, s, &changes); }
+            int residual = demands[p][s] - path.deliveredQuantities[p][s];
+            for (ID d = 0; d < c; ++d) {
+                if (loads[d].station == s) { residual -= loads[d].quantity; }
+            }
+            loads[c].station = s;
+            loads[c].quantity = (min)(guideLoads[c].quantity, residual);
+            if (loads[c].quantity <= 0) { loads[c] = Plan::CabinLoad(); }
+        }
+        assign(path, p, v, loads, changes);
+    };
+
+    // each step samples a few of the remaining moves and takes the best one. the end points are local
+    // optima, so only the intermediate plans are candidates for polishing.
+    Plan path(plan);
+    Plan bestPath;
+    List<LoadChange> changes;
+    while (!differences.empty() && !isStopped()) {
+        ID sampleNum = (min)(static_cast<ID>(differences.size()), cfg.relinkSampleNum);
+        for (ID i = 0; i < sampleNum; ++i) { swap(differences[i], differences[i + rng.pick(static_cast<ID>(differences.size()) - i)]); }
+        ID bestMove = 0;
+        Revenue bestObj = -(numeric_limits<Revenue>::max)();
+        for (ID i = 0; i < sampleNum; ++i) {
+            copyLoads(path, differences[i], changes);
+            if (path.obj > bestObj) {
+                bestMove = i;
+                bestObj = path.obj;
+            }
+            rollback(path, changes);
+        }
+        copyLoads(path, differences[bestMove], changes);
+        changes.clear();
+        swap(differences[bestMove], differences.back());
+        differences.pop_back();
+
+        // the releases may have made some vehicle-periods equal to the guide.
+        differences.erase(remove_if(differences.begin(), differences.end(), [&](ID i) { return !differs(path, i); }), differences.end());
+        if (differences.empty()) { break; }
+        if (bestPath.loads.empty() || (path.obj > bestPath.obj)) { bestPath = path; }
+    }
+    if (bestPath.loads.empty()) { return false; }
+
+    variableNeighborhoodDescent(bestPath, rng);
+    if (bestPath.obj <= plan.obj + Math::DefaultTolerance * Math::DefaultTolerance) { return false; }
+    plan = bestPath;
+    return true;
+}
+
+void Solver::antColony(Plan &plan, ID workerId) {
+    Random &rng(workerRands[workerId]);
+
+    // max-min ant system. the trails are bounded by the equilibrium of depositing 1 per batch.
+    double maxTrail = 1 / cfg.evaporationRate;
+    double minTrail = maxTrail / (2 * stationNumber);
+    Pheromone pheromone;
+    pheromone.init(stationNumber, periodNumber, vehicleNumber, maxTrail);
+    auto deposit = [&](const Plan &ant, double amount) {
+        for (ID p = 0; p < periodNumber; ++p) {
+            for (ID v = 0; v < vehicleNumber; ++v) {
+                ID windowStart = stationNumber;
+                for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                    const Plan::CabinLoad &load(ant.loads[loadIndex(p, v, c)]);
+                    if (load.quantity > 0) { windowStart = (min)(windowStart, load.station); }
+                }
+                if (windowStart < stationNumber) { pheromone.depositVehicleWindow(v, windowStart, amount); }
+            }
+        }
+        for (ID s = 0; s < stationNumber; ++s) {
+            if (ant.stationPeriods[s] != Problem::InvalidId) { pheromone.depositStationPeriod(s, ant.stationPeriods[s], amount); }
+        }
+    };
+
+    // the ants of a batch are built by the threads of the worker, each with its own random stream.
+    int threadNum = (max)(1, cfg.threadNumPerWorker);
+    List<Random> rngs;
+    for (int t = 0; t < threadNum; ++t) { rngs.emplace_back(static_cast<int>(rng())); }
+    List<Plan> ants(cfg.antNum);
+    Plan bestPlan(plan);
+    Iteration iter = 0;
+    for (; (iter == 0) || (!isEngineStopped() && (iter < env.maxIter)); ++iter) {
+        migrate(bestPlan, workerId, iter);
+        ThreadTeam::local().run(threadNum, [&](int t) {
+            for (size_t a = t; a < ants.size(); a += threadNum) {
+                initPlan(ants[a]);
+                constructByAnt(ants[a], pheromone, rngs[t]);
+                localSearch(ants[a], rngs[t]);
+            }
+        });
+
+        auto iterBest = max_element(ants.begin(), ants.end(), [](const Plan &l, const Plan &r) { return l.obj < r.obj; });
+        if (iterBest->obj > bestPlan.obj + Math::DefaultTolerance * Math::DefaultTolerance) {
+            bestPlan = *iterBest;
+            variableNeighborhoodDescent(bestPlan, rng);
+            reportObjective(bestPlan.obj);
+        }
+
+        // update the trails once per batch by the best ant of the batch and the best plan so far.
+        pheromone.evaporate(cfg.evaporationRate);
+        deposit(*iterBest, 0.5);
+        deposit(bestPlan, 0.5);
+        pheromone.clamp(minTrail, maxTrail);
+    }
+    Log(LogSwitch::LCG::Framework) << "worker " << workerId << " releases " << iter << " batches of " << ants.size() << " ants." << endl;
+    plan = bestPlan;
+}
+
+void Solver::fixAndOptimize(Plan &plan, ID workerId) {
+    Random &rng(workerRands[workerId]);
+    variableNeighborhoodDescent(plan, rng);
+    reportObjective(plan.obj);
+
+    // perturb the best plan only when no pair can be improved.
+    Plan bestPlan(plan);
+    ID ruinSize = 1;
+    Iteration iter = 0;
+    Iteration perturbationNum = 0;
+    for (; !isEngineStopped() && (iter < env.maxIter); ++iter) {
+        if (migrate(bestPlan, workerId, iter)) { plan = bestPlan; }
+        if (!resolvePairs(plan, rng)) {
+            perturb(plan, ruinSize, rng);
+            ++perturbationNum;
+        }
+        variableNeighborhoodDescent(plan, rng);
+        if (plan.obj > bestPlan.obj + Math::DefaultTolerance * Math::DefaultTolerance) {
+            bestPlan = plan;
+            reportObjective(bestPlan.obj);
+            ruinSize = 1;
+        } else {
+            plan = bestPlan;
+            ruinSize = (min)(2 * ruinSize, vehicleNumber);
+        }
+    }
+    Log(LogSwitch::LCG::Framework) << "worker " << workerId << " makes " << iter << " pair cycles with "
+        << perturbationNum << " perturbations." << endl;
+    plan = bestPlan;
+}
+
+bool Solver::reoptimize(Problem::Output &sln, const List<DemandUpdate> &updates) {
+    Log(LogSwitch::LCG::Framework) << "reoptimize " << updates.size() << " demand updates." << endl;
+    // the instance data is built by solve(), which may not have been called.
+    if (periodNumber <= 0) { init(); }
+
+    // leave the input untouched if any update is invalid.
+    for (auto u = updates.begin(); u != updates.end(); ++u) {
+        if ((u->station < 0) || (u->station >= stationNumber) || (u->period < 0) || (u->period >= periodNumber)) { return false; }
+    }
+    for (auto u = updates.begin(); u != updates.end(); ++u) {
+        // the demand lists of the stations may be shorter than the number of periods.
+        auto *station = input.mutable_gasstations(u->station);
+        while (station->demandvalues_size() <= u->period) {
+            auto *demandValue = station->add_demandvalues();
+            demandValue->set_demand(0);
+            demandValue->set_value(0);
+        }
+        auto &demandValue(*station->mutable_demandvalues(u->period));
+        demandValue.set_demand(u->demand);
+        demandValue.set_value(u->value);
+    }
+    initInstanceData();
+    extractFeatures();
+    preprocess();
+    oracleCache.init(cfg.deterministic ? 0 : cfg.oracleCacheSize);
+    bound = upperBound();
+
+    // the budget of solve() may be used up, so the re-optimization runs under a short deadline of its own.
+    Timer deadline(std::chrono::milliseconds(static_cast<Duration>(cfg.reoptimizeTimeout * Timer::MillisecondsPerSecond)));
+    auto isTimeout = [&]() { return Cancellation::isRequested() || (!cfg.deterministic && deadline.isTimeOut()); };
+
+    repair(sln);
+    Plan plan;
+    toPlan(sln, plan);
+
+    // a vehicle-period is affected if it serves an updated station or the station lies in its station id span.
+    // the vehicle-periods serving an updated station in another period may release it as well.
+    List<Plan::CabinLoad> loads;
+    for (ID p = 0; p < periodNumber; ++p) {
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            ID minStationId = stationNumber;
+            ID maxStationId = Problem::InvalidId;
+            for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                const Plan::CabinLoad &load(plan.loads[loadIndex(p, v, c)]);
+                if (load.quantity <= 0) { continue; }
+                minStationId = (min)(minStationId, load.station);
+                maxStationId = (max)(maxStationId, load.station);
+            }
+
+            bool affected = false;
+            for (auto u = updates.begin(); !affected && (u != updates.end()); ++u) {
+                if (u->period == p) {
+                    affected = ((minStationId <= u->station) && (u->station <= maxStationId));
+                } else {
+                    affected = (plan.stationPeriods[u->station] == p) && (minStationId <= u->station) && (u->station <= maxStationId);
+                }
+            }
+            // an idle vehicle may be dispatched to the updated stations.
+            if (!affected && (maxStationId < 0)) { affected = true; }
+            if (!affected) { continue; }
+
+            Revenue value = optimizeVehiclePeriod(plan, p, v, loads);
+            if (value > plan.vehicleValues[p][v]) { assign(plan, p, v, loads); }
+        }
+    }
+
+    // passes of the oracle over all vehicle-periods as localSearch() does, but under the deadline.
+    List<ID> vehiclePeriods(periodNumber * vehicleNumber);
+    for (ID i = 0; i < periodNumber * vehicleNumber; ++i) { vehiclePeriods[i] = i; }
+    for (bool improved = true; improved && !isTimeout();) {
+        improved = false;
+        shuffle(vehiclePeriods.begin(), vehiclePeriods.end(), rand.rgen);
+        for (auto i = vehiclePeriods.begin(); (i != vehiclePeriods.end()) && !isTimeout(); ++i) {
+            ID p = *i / vehicleNumber;
+            ID v = *i % vehicleNumber;
+            Revenue value = optimizeVehiclePeriod(plan, p, v, loads);
+            if (value <= plan.vehicleValues[p][v] + Math::DefaultTolerance * Math::DefaultTolerance) { continue; }
+            assign(plan, p, v, loads);
+            improved = true;
+        }
+    }
+
+    toOutput(plan, sln);
+    output = sln;
+    return true;
+}
+
+void Solver::initPlan(Plan &plan) const {
+    plan.loads.assign(periodNumber * cabinNumber, Plan::CabinLoad());
+    plan.deliveredQuantities.init(periodNumber, stationNumber);
+    plan.deliveredQuantities.reset();
+    plan.stationPeriods.assign(stationNumber, Problem::InvalidId);
+    plan.servedStations.assign(periodNumber, Bitset(stationNumber));
+    plan.freeStations.resize(stationNumber);
+    for (ID s = 0; s < stationNumber; ++s) { plan.freeStations.set(s); }
+    plan.unmetStations = candidateStations;
+    plan.vehicleValues.init(periodNumber, vehicleNumber);
+    std::fill(plan.vehicleValues.begin(), plan.vehicleValues.end(), 0.0);
+    plan.obj = 0.0;
+    plan.hash = 0;
+    initResiduals(plan);
+}
+
+void Solver::toPlan(const Problem::Output &sln, Plan &plan) const {
+    initPlan(plan);
+    for (ID p = 0; (p < periodNumber) && (p < sln.deliveries_size()); ++p) {
+        for (auto vd = sln.deliveries(p).vehicledeliveries().begin(); vd != sln.deliveries(p).vehicledeliveries().end(); ++vd) {
+            for (auto cd = vd->cabindeliveries().begin(); cd != vd->cabindeliveries().end(); ++cd) {
+                if (cd->quantity() <= 0) { continue; }
+                ID index = loadIndex(p, vd->id(), cd->id());
+                Plan::CabinLoad &load(plan.loads[index]);
+                load.station = cd->stationid();
+                load.quantity = cd->quantity();
+                plan.hash ^= loadKey(index, load);
+                plan.deliveredQuantities[p][load.station] += load.quantity;
+                plan.stationPeriods[load.station] = p;
+                plan.servedStations[p].set(load.station);
+                plan.freeStations.reset(load.station);
+                if (plan.deliveredQuantities[p][load.station] >= demands[p][load.station]) { plan.unmetStations[p].reset(load.station); }
+            }
+        }
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            plan.vehicleValues[p][v] = vehiclePeriodValue(plan, p, v);
+            plan.obj += plan.vehicleValues[p][v];
+        }
+    }
+    initResiduals(plan);
+}
+
+void Solver::toOutput(const Plan &plan, Problem::Output &sln) const {
+    sln.Clear();
+    auto &deliveries(*sln.mutable_deliveries());
+    deliveries.Reserve(periodNumber);
+    for (ID p = 0; p < periodNumber; ++p) {
+        auto &delivery(*sln.add_deliveries());
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            auto &vd(*delivery.add_vehicledeliveries());
+            vd.set_id(v);
+            for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                const Plan::CabinLoad &load(plan.loads[loadIndex(p, v, c)]);
+                if (load.quantity <= 0) { continue; }
+                auto &cd(*vd.add_cabindeliveries());
+                cd.set_id(c);
+                cd.set_stationid(load.station);
+                cd.set_quantity(load.quantity);
+            }
+        }
+    }
+    sln.sumTotal = plan.obj;
+}
+
+void Solver::initResiduals(Plan &plan) const {
+    plan.residualDemands.resize(periodNumber);
+    plan.residualValues.resize(periodNumber);
+    plan.residualHashes.assign(periodNumber, 0);
+    List<int> residuals(stationNumber);
+    List<double> values(stationNumber);
+    for (ID p = 0; p < periodNumber; ++p) {
+        for (ID s = 0; s < stationNumber; ++s) {
+            residuals[s] = residualOf(plan, p, s);
+            values[s] = residuals[s] * unitValues[p][s];
+            if (residuals[s] > 0) { plan.residualHashes[p] ^= residualKey(p, s, residuals[s]); }
+        }
+        plan.residualDemands[p].init(residuals.begin(), stationNumber);
+        plan.residualValues[p].init(values.begin(), stationNumber);
+    }
+}
+
+int Solver::residualOf(const Plan &plan, ID period, ID station) const {
+    if (!plan.unmetStations[period].test(station)) { return 0; }
+    if ((plan.stationPeriods[station] != Problem::InvalidId) && (plan.stationPeriods[station] != period)) { return 0; }
+    return demands[period][station] - plan.deliveredQuantities[period][station];
+}
+
+void Solver::trackResiduals(Plan &plan, ID station, int sign) const {
+    for (ID p = 0; p < periodNumber; ++p) {
+        int residual = residualOf(plan, p, station);
+        if (residual == 0) { continue; }
+        plan.residualDemands[p].add(station, sign * residual);
+        plan.residualValues[p].add(station, sign * residual * unitValues[p][station]);
+        plan.residualHashes[p] ^= residualKey(p, station, residual);
+    }
+}
+
+void Solver::assign(Plan &plan, ID period, ID vehicle, const List<Plan::CabinLoad> &loads) const {
+    Plan::CabinLoad *oldLoads = plan.loads.data() + loadIndex(period, vehicle);
+    List<ID> touchedStations;
+    touchedStations.reserve(2 * cabinNumberOf(vehicle));
+    for (ID c = 0; c < cabinNumberOf(vehicle); ++c) {
+        if (oldLoads[c].quantity > 0) { touchedStations.push_back(oldLoads[c].station); }
+        if (loads[c].quantity > 0) { touchedStations.push_back(loads[c].station); }
+    }
+    sort(touchedStations.begin(), touchedStations.end());
+    touchedStations.erase(unique(touchedStations.begin(), touchedStations.end()), touchedStations.end());
+    for (auto s = touchedStations.begin(); s != touchedStations.end(); ++s) { trackResiduals(plan, *s, -1); }
+
+    int *delivered = plan.deliveredQuantities[period];
+    Bitset &served(plan.servedStations[period]);
+    Bitset &unmet(plan.unmetStations[period]);
+    for (ID c = 0; c < cabinNumberOf(vehicle); ++c) {
+        if (oldLoads[c].quantity <= 0) { continue; }
+        ID s = oldLoads[c].station;
+        if (candidateStations[period].test(s)) { unmet.set(s); }
+        if ((delivered[s] -= oldLoads[c].quantity) > 0) { continue; }
+        plan.stationPeriods[s] = Problem::InvalidId;
+        served.reset(s);
+        plan.freeStations.set(s);
+    }
+    ID index = loadIndex(period, vehicle);
+    for (ID c = 0; c < cabinNumberOf(vehicle); ++c) {
+        if (oldLoads[c].quantity > 0) { plan.hash ^= loadKey(index + c, oldLoads[c]); }
+        if (loads[c].quantity > 0) { plan.hash ^= loadKey(index + c, loads[c]); }
+        oldLoads[c] = loads[c];
+        if (loads[c].quantity <= 0) { continue; }
+        ID s = loads[c].station;
+        if ((delivered[s] += loads[c].quantity) >= demands[period][s]) { unmet.reset(s); }
+        plan.stationPeriods[s] = period;
+        served.set(s);
+        plan.freeStations.reset(s);
+    }
+    for (auto s = touchedStations.begin(); s != touchedStations.end(); ++s) { trackResiduals(plan, *s, 1); }
+
+    Revenue value = vehiclePeriodValue(plan, period, vehicle);
+    plan.obj += value - plan.vehicleValues[period][vehicle];
+    plan.vehicleValues[period][vehicle] = value;
+}
+
+void Solver::windowOf(const Plan &plan, ID period, ID vehicle, ID &minStationId, ID &maxStationId) const {
+    minStationId = stationNumber;
+    maxStationId = Problem::InvalidId;
+    const Plan::CabinLoad *loads = plan.loads.data() + loadIndex(period, vehicle);
+    for (ID c = 0; c < cabinNumberOf(vehicle); ++c) {
+        if (loads[c].quantity <= 0) { continue; }
+        minStationId = (min)(minStationId, loads[c].station);
+        maxStationId = (max)(maxStationId, loads[c].station);
+    }
+}
+
+bool Solver::isAssignable(const Plan &plan, ID period, ID vehicle, const List<Plan::CabinLoad> &loads) const {
+    const Plan::CabinLoad *oldLoads = plan.loads.data() + loadIndex(period, vehicle);
+    for (ID c = 0; c < cabinNumberOf(vehicle); ++c) {
+        if (loads[c].quantity <= 0) { continue; }
+        ID s = loads[c].station;
+        if ((plan.stationPeriods[s] != Problem::InvalidId) && (plan.stationPeriods[s] != period)) { return false; }
+        int delivered = plan.deliveredQuantities[period][s];
+        for (ID d = 0; d < cabinNumberOf(vehicle); ++d) {
+            if ((oldLoads[d].quantity > 0) && (oldLoads[d].station == s)) { delivered -= oldLoads[d].quantity; }
+            if ((loads[d].quantity > 0) && (loads[d].station == s)) { delivered += loads[d].quantity; }
+        }
+        if (delivered > demands[period][s]) { return false; }
+    }
+    return true;
+}
+
+void Solver::assign(Plan &plan, ID period, ID vehicle, const List<Plan::CabinLoad> &loads, List<LoadChange> &changes) const {
+    const Plan::CabinLoad *oldLoads = plan.loads.data() + loadIndex(period, vehicle);
+    changes.push_back({ period, vehicle, List<Plan::CabinLoad>(oldLoads, oldLoads + cabinNumberOf(vehicle)) });
+    assign(plan, period, vehicle, loads);
+}
+
+void Solver::rollback(Plan &plan, List<LoadChange> &changes) const {
+    for (auto c = changes.rbegin(); c != changes.rend(); ++c) { assign(plan, c->period, c->vehicle, c->loads); }
+    changes.clear();
+}
+
+Revenue Solver::vehiclePeriodValue(const Plan &plan, ID period, ID vehicle) const {
+    return vehiclePeriodValue(period, vehicle, plan.loads.data() + loadIndex(period, vehicle));
+}
+
+Revenue Solver::vehiclePeriodValue(ID period, ID vehicle, const Plan::CabinLoad *loads) const {
+    const double *unitValue = unitValues[period];
+    double vehicleValue = 0.0;
+    int vehicleLoad = 0;
+    ID maxStationId = Problem::InvalidId;
+    ID minStationId = stationNumber;
+    for (ID c = 0; c < cabinNumberOf(vehicle); ++c) {
+        if (loads[c].quantity <= 0) { continue; }
+        vehicleValue += loads[c].quantity * unitValue[loads[c].station];
+        vehicleLoad += loads[c].quantity;
+        maxStationId = (max)(maxStationId, loads[c].station);
+        minStationId = (min)(minStationId, loads[c].station);
+    }
+    if (vehicleLoad <= 0) { return 0.0; }
+
+    ID k = cabinNumberOf(vehicle);
+    return vehicleValue * vehicleLoad / vehicleVolumes[vehicle] * k / (k + maxStationId - minStationId);
+}
+
+void Solver::evaluateMoves(const Plan &plan, ID period, ID vehicle, MoveBatch &moves) const {
+    const Plan::CabinLoad *loads = plan.loads.data() + loadIndex(period, vehicle);
+    const double *unitValue = unitValues[period];
+    ID k = cabinNumberOf(vehicle);
+
+    // the aggregates of the vehicle without each cabin so that every move is scored in O(1).
+    double vehicleValue = 0.0;
+    int vehicleLoad = 0;
+    List<double> cabinValues(k, 0.0);
+    List<ID> maxStationIds(k, Problem::InvalidId);
+    List<ID> minStationIds(k, stationNumber);
+    for (ID c = 0; c < k; ++c) {
+        if (loads[c].quantity <= 0) { continue; }
+        cabinValues[c] = loads[c].quantity * unitValue[loads[c].station];
+        vehicleValue += cabinValues[c];
+        vehicleLoad += loads[c].quantity;
+        for (ID other = 0; other < k; ++other) {
+            if (other == c) { continue; }
+            maxStationIds[other] = (max)(maxStationIds[other], loads[c].station);
+            minStationIds[other] = (min)(minStationIds[other], loads[c].station);
+        }
+    }
+    Revenue oldValue = plan.vehicleValues[period][vehicle];
+    double volume = vehicleVolumes[vehicle];
+
+    // an idle cabin takes an id inside the rest window so that it does not widen the span.
+    ID moveNum = moves.size();
+    moves.deltas.resize(moveNum);
+    const ID *cabins = moves.cabins.data();
+    const ID *stations = moves.stations.data();
+    const int *quantities = moves.quantities.data();
+    Revenue *deltas = moves.deltas.data();
+    for (ID m = 0; m < moveNum; ++m) {
+        ID c = cabins[m];
+        int quantity = quantities[m];
+        ID station = (quantity > 0) ? stations[m] : (min)(maxStationIds[c], minStationIds[c]);
+        double value = vehicleValue - cabinValues[c] + quantity * unitValue[(max)(station, 0)];
+        int load = vehicleLoad - loads[c].quantity + quantity;
+        ID span = (max)(maxStationIds[c], station) - (min)(minStationIds[c], station);
+        deltas[m] = ((load > 0) ? (value * load / volume * k / (k + (max)(span, 0))) : 0.0) - oldValue;
+    }
+}
+
+Revenue Solver::optimizeVehiclePeriod(const Plan &plan, ID period, ID vehicle, List<Plan::CabinLoad> &loads, int threadNum) const {
+    // given the stations of all cabins, filling every cabin as much as possible raises both the
+    // total value and the full load rate, so only the cabin-to-station assignment is searched.
+    // each assignment is enumerated once in the window between its min and max station ids.
+    ID k = cabinNumberOf(vehicle);
+    double volume = vehicleVolumes[vehicle];
+    const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(period, vehicle);
+    const double *unitValue = unitValues[period];
+
+    loads.assign(curLoads, curLoads + k);
+    Revenue bestValue = plan.vehicleValues[period][vehicle];
+
+    // residual demand of a station available in this period without the current loads of the vehicle.
+    auto freedResidualOf = [&](ID s) {
+        int residual = residualOf(plan, period, s);
+        if (plan.stationPeriods[s] == period) {
+            for (ID c = 0; c < k; ++c) {
+                if ((curLoads[c].quantity > 0) && (curLoads[c].station == s)) { residual += curLoads[c].quantity; }
+            }
+        }
+        return residual;
+    };
+
+    // the result only depends on the residual demands seen by the vehicle and its cabin volumes.
+    const ID *cabins = cabinOrders.data() + cabinOffsets[vehicle];
+    Hash::Key key = plan.residualHashes[period];
+    for (ID c = 0; c < k; ++c) {
+        ID s = curLoads[c].station;
+        if ((curLoads[c].quantity <= 0) || !candidateStations[period].test(s)) { continue; }
+        bool counted = false;
+        for (ID other = 0; !counted && (other < c); ++other) { counted = (curLoads[other].quantity > 0) && (curLoads[other].station == s); }
+        if (counted) { continue; }
+        int residual = residualOf(plan, period, s);
+        if (residual > 0) { key ^= residualKey(period, s, residual); }
+        key ^= residualKey(period, s, freedResidualOf(s));
+    }
+    key = Hash::combine(key, static_cast<Hash::Key>(period) * vehicleClassNumber + vehicleClasses[vehicle]);
+    auto remember = [&]() {
+        OracleResult result;
+        result.value = bestValue;
+        result.loads.resize(k);
+        for (ID t = 0; t < k; ++t) { result.loads[t] = loads[cabins[t]]; }
+        oracleCache.put(key, result);
+        return bestValue;
+    };
+    OracleResult cached;
+    if (oracleCache.get(key, cached) && (static_cast<ID>(cached.loads.size()) == k)) {
+        // verify the loads against the real residual demands in case of hash collisions.
+        bool valid = true;
+        for (ID t = 0; valid && (t < k); ++t) {
+            ID s = cached.loads[t].station;
+            if (cached.loads[t].quantity <= 0) { continue; }
+            int quantity = 0;
+            for (ID other = 0; other < k; ++other) {
+                if ((cached.loads[other].quantity > 0) && (cached.loads[other].station == s)) { quantity += cached.loads[other].quantity; }
+            }
+            valid = candidateStations[period].test(s) && (quantity <= freedResidualOf(s));
+        }
+        if (valid) {
+            if (cached.value <= bestValue) { return bestValue; }
+            for (ID t = 0; t < k; ++t) { loads[cabins[t]] = cached.loads[t]; }
+            return cached.value;
+        }
+    }
+
+    // the stations free or served in this period with residual demand, and those served by this vehicle.
+    const Bitset &unmet(plan.unmetStations[period]);
+    const Bitset &served(plan.servedStations[period]);
+    const Bitset &free(plan.freeStations);
+    List<ID> candidates; // station ids in increasing order.
+    candidates.reserve(unmet.count() + k);
+    Bitset::enumerate(unmet.words(), [&](int w) { return (free.word(w) | served.word(w)) & unmet.word(w); },
+        [&](int s) { candidates.push_back(s); });
+    for (ID c = 0; c < k; ++c) {
+        if ((curLoads[c].quantity <= 0) || unmet.test(curLoads[c].station) || !candidateStations[period].test(curLoads[c].station)) { continue; }
+        auto pos = lower_bound(candidates.begin(), candidates.end(), curLoads[c].station);
+        if ((pos == candidates.end()) || (*pos != curLoads[c].station)) { candidates.insert(pos, curLoads[c].station); }
+    }
+    if (candidates.empty()) { return remember(); }
+    List<int> residuals(candidates.size());
+    for (size_t i = 0; i < candidates.size(); ++i) { residuals[i] = freedResidualOf(candidates[i]); }
+
+    // cabins in decreasing volume so that large cabins are decided first.
+    const int *volumes = cabinVolumes.data() + cabinOffsets[vehicle];
+
+    // the total value of a full vehicle by the fractional knapsack, which bounds the value of any span.
+    double valueBound = 0.0;
+    int restVolume = vehicleVolumes[vehicle];
+    for (auto s = periodStationsByUnitValue[period].begin(); (restVolume > 0) && (s != periodStationsByUnitValue[period].end()); ++s) {
+        int quantity = (min)(restVolume, freedResidualOf(*s));
+        if (quantity <= 0) { continue; }
+        valueBound += quantity * unitValue[*s];
+        restVolume -= quantity;
+    }
+    // each cabin serves one station, so it earns at most the best value and load of a single station.
+    List<double> cabinValueBounds(k, 0.0);
+    List<int> cabinLoadBounds(k, 0);
+    for (ID i = 0; i < static_cast<ID>(candidates.size()); ++i) {
+        for (ID t = 0; t < k; ++t) {
+            int quantity = (min)(volumes[cabins[t]], residuals[i]);
+            cabinValueBounds[t] = (max)(cabinValueBounds[t], quantity * unitValue[candidates[i]]);
+            cabinLoadBounds[t] = (max)(cabinLoadBounds[t], quantity);
+        }
+    }
+    valueBound = (min)(valueBound, accumulate(cabinValueBounds.begin(), cabinValueBounds.end(), 0.0));
+    double loadBound = accumulate(cabinLoadBounds.begin(), cabinLoadBounds.end(), 0);
+    double objBound = valueBound * loadBound / volume;
+
+    // serving a single station is trivial and gives a tight lower bound for the wider windows.
+    ID candidateNum = static_cast<ID>(candidates.size());
+    ID bestSingle = Problem::InvalidId;
+    for (ID i = 0; i < candidateNum; ++i) {
+        double load = (min)(volume, static_cast<double>(residuals[i]));
+        double value = unitValue[candidates[i]] * load * load / volume;
+        if (value <= bestValue) { continue; }
+        bestValue = value;
+        bestSingle = i;
+    }
+    if (bestSingle != Problem::InvalidId) {
+        int left = residuals[bestSingle];
+        for (ID t = 0; t < k; ++t) {
+            Plan::CabinLoad &load(loads[cabins[t]]);
+            load.quantity = (min)(volumes[cabins[t]], left);
+            load.station = (load.quantity > 0) ? candidates[bestSingle] : Problem::InvalidId;
+            left -= load.quantity;
+        }
+    }
+
+    // the search state of a thread on the windows.
+    struct WindowSearch {
+        List<int> lefts;
+        List<ID> choices; // index in the window, or windowSize for an idle cabin.
+        // the bounds of cabins in the window and their suffix sums on cabins[t..k).
+        List<double> windowValueBounds;
+        List<int> windowLoadBounds;
+        List<double> restValueBounds;
+        List<int> restLoadBounds;
+        // the best window found by the thread.
+        Revenue bestValue = 0.0;
+        ID bestLo = Problem::InvalidId;
+        ID bestHi;
+        List<ID> bestChoices;
+        long long nodeNum = 0;
+    };
+    int searchNum = ((threadNum > 1) && (candidateNum > cfg.parallelOracleCandidateNum)) ? threadNum : 1;
+    List<WindowSearch> searches(searchNum);
+    for (auto ws = searches.begin(); ws != searches.end(); ++ws) {
+        ws->lefts.resize(candidateNum);
+        ws->choices.resize(k);
+        ws->windowValueBounds.resize(k);
+        ws->windowLoadBounds.resize(k);
+        ws->restValueBounds.assign(k + 1, 0.0);
+        ws->restLoadBounds.assign(k + 1, 0);
+    }
+    Incumbent incumbent(bestValue);
+
+    // the residual demand and its value in [candidates[lo], candidates[hi]] including the current loads.
+    const FenwickTree<int> &residualDemands(plan.residualDemands[period]);
+    const FenwickTree<double> &residualValues(plan.residualValues[period]);
+    auto windowSums = [&](ID lo, ID hi, int &demand, double &value) {
+        demand = residualDemands.sum(candidates[lo], candidates[hi]);
+        value = residualValues.sum(candidates[lo], candidates[hi]);
+        for (ID c = 0; c < k; ++c) {
+            if ((curLoads[c].quantity <= 0) || (curLoads[c].station < candidates[lo]) || (curLoads[c].station > candidates[hi])) { continue; }
+            demand += curLoads[c].quantity;
+            value += curLoads[c].quantity * unitValue[curLoads[c].station];
+        }
+    };
+
+    // the upper ends of the windows worth searching from each lower end.
+    List<double> ids(candidateNum);
+    List<double> valuePrefixes(candidateNum + 1, 0.0);
+    List<double> residualPrefixes(candidateNum + 1, 0.0);
+    for (ID i = 0; i < candidateNum; ++i) {
+        ids[i] = candidates[i];
+        valuePrefixes[i + 1] = valuePrefixes[i] + residuals[i] * unitValue[candidates[i]];
+        residualPrefixes[i + 1] = residualPrefixes[i] + residuals[i];
+    }
+    WindowBound::Candidates soa = { candidateNum, ids.data(), valuePrefixes.data(), residualPrefixes.data() };
+    WindowBound::Vehicle vehicleBounds = { static_cast<double>(k), volume, valueBound, loadBound };
+    List<int> lastOffsets(candidateNum);
+    WindowBound::lastAliveOffsets(soa, vehicleBounds, bestValue, lastOffsets.data());
+
+    // widen the window bounds of ws by the station candidates[x].
+    auto addToWindow = [&](WindowSearch &ws, ID x) {
+        for (ID t = 0; t < k; ++t) {
+            int quantity = (min)(volumes[cabins[t]], residuals[x]);
+            ws.windowLoadBounds[t] = (max)(ws.windowLoadBounds[t], quantity);
+            ws.windowValueBounds[t] = (max)(ws.windowValueBounds[t], quantity * unitValue[candidates[x]]);
+        }
+    };
+    // search [lo, hi] with the window bounds already set in ws.
+    auto searchWindow = [&](WindowSearch &ws, ID lo, ID hi) {
+        double loadSharing = 1.0 * k / (k + candidates[hi] - candidates[lo]);
+        for (ID t = k; t-- > 0;) {
+            ws.restValueBounds[t] = ws.restValueBounds[t + 1] + ws.windowValueBounds[t];
+            ws.restLoadBounds[t] = ws.restLoadBounds[t + 1] + ws.windowLoadBounds[t];
+        }
+        if (ws.restValueBounds[0] * ws.restLoadBounds[0] / volume * loadSharing <= incumbent.get()) { return; }
+        // the cabins cannot take more than the whole residual demand in the window.
+        int windowResidual;
+        double windowValue;
+        windowSums(lo, hi, windowResidual, windowValue);
+        ws.restValueBounds[0] = (min)(ws.restValueBounds[0], windowValue);
+        if (ws.restValueBounds[0] * (min)(ws.restLoadBounds[0], windowResidual) / volume * loadSharing <= incumbent.get()) { return; }
+
+        ID windowSize = hi - lo + 1;
+        List<int> &lefts(ws.lefts);
+        List<ID> &choices(ws.choices);
+        copy(residuals.begin() + lo, residuals.begin() + hi + 1, lefts.begin());
+
+        // depth-first search on the station of each cabin with the endpoints of the window both used.
+        function<void(ID, double, int, int)> dfs = [&](ID t, double value, int load, int leftSum) {
+            ++ws.nodeNum;
+            int reachable = (min)(ws.restLoadBounds[t], leftSum);
+            if ((value + ws.restValueBounds[t]) * (load + reachable) / volume * loadSharing <= incumbent.get()) { return; }
+            if (t >= k) {
+                if ((lefts[0] == residuals[lo]) || (lefts[windowSize - 1] == residuals[hi])) { return; }
+                Revenue obj = value * load / volume * loadSharing;
+                if (!incumbent.raise(obj)) { return; }
+                ws.bestValue = obj;
+                ws.bestLo = lo;
+                ws.bestHi = hi;
+                ws.bestChoices = choices;
+                return;
+            }
+
+            int cabinVolume = volumes[cabins[t]];
+            bool twin = (t > 0) && (volumes[cabins[t - 1]] == cabinVolume); // break symmetry of equal cabins.
+            for (ID x = (twin ? choices[t - 1] : 0); x < windowSize; ++x) {
+                if (lefts[x] <= 0) { continue; }
+                int quantity = (min)(cabinVolume, lefts[x]);
+                lefts[x] -= quantity;
+                choices[t] = x;
+                dfs(t + 1, value + quantity * unitValue[candidates[lo + x]], load + quantity, leftSum - quantity);
+                lefts[x] += quantity;
+            }
+            choices[t] = windowSize; // leave the cabin idle.
+            dfs(t + 1, value, load, leftSum);
+        };
+        dfs(0, 0.0, 0, windowResidual);
+    };
+
+    if (searchNum == 1) {
+        // the window bounds are widened incrementally along hi.
+        WindowSearch &ws(searches[0]);
+        for (ID lo = 0; lo < candidateNum; ++lo) {
+            if (lastOffsets[lo] <= 0) { continue; }
+            fill(ws.windowLoadBounds.begin(), ws.windowLoadBounds.end(), 0);
+            fill(ws.windowValueBounds.begin(), ws.windowValueBounds.end(), 0.0);
+            addToWindow(ws, lo);
+            for (ID hi = lo + 1; hi <= lo + lastOffsets[lo]; ++hi) {
+                // the load sharing decreases with the span.
+                if (objBound * k / (k + candidates[hi] - candidates[lo]) <= incumbent.get()) { break; }
+                addToWindow(ws, hi);
+                searchWindow(ws, lo, hi);
+            }
+        }
+    } else {
+        // the root of lo has a child for each window [lo, hi]. the roots are the shallowest nodes,
+        // so the idle threads steal whole lower ends first and single windows when those run out.
+        struct Window {
+            ID lo;
+            ID hi; // the root of lo if it is invalid.
+        };
+        List<Window> roots;
+        for (ID lo = 0; lo < candidateNum; ++lo) {
+            if (lastOffsets[lo] > 0) { roots.push_back({ lo, Problem::InvalidId }); }
+        }
+        WorkStealingSearch<Window> search;
+        search.run(searchNum, roots, [&](int t, const Window &node, const function<void(const Window&)> &push) {
+            if (node.hi == Problem::InvalidId) {
+                ID lastHi = node.lo + 1;
+                for (; lastHi <= node.lo + lastOffsets[node.lo]; ++lastHi) {
+                    if (objBound * k / (k + candidates[lastHi] - candidates[node.lo]) <= incumbent.get()) { break; }
+                }
+                // the narrow windows are pushed last to be searched first by the owner.
+                for (ID hi = lastHi; hi-- > node.lo + 1;) { push({ node.lo, hi }); }
+                return;
+            }
+            WindowSearch &ws(searches[t]);
+            fill(ws.windowLoadBounds.begin(), ws.windowLoadBounds.end(), 0);
+            fill(ws.windowValueBounds.begin(), ws.windowValueBounds.end(), 0.0);
+            for (ID x = node.lo; x <= node.hi; ++x) { addToWindow(ws, x); }
+            searchWindow(ws, node.lo, node.hi);
+        });
+
+        long long nodeNum = 0;
+        long long busiestNodeNum = 0;
+        for (auto ws = searches.begin(); ws != searches.end(); ++ws) {
+            nodeNum += ws->nodeNum;
+            busiestNodeNum = (max)(busiestNodeNum, ws->nodeNum);
+        }
+        const List<long long> &steals(search.stealNumsOfThreads());
+        ++parallelOracleNum;
+        stealNum += accumulate(steals.begin(), steals.end(), 0LL);
+        branchNodeNum += nodeNum;
+        busiestBranchNodeNum += busiestNodeNum * searchNum;
+    }
+
+    // only the thread raising the incumbent last holds the best window.
+    for (auto ws = searches.begin(); ws != searches.end(); ++ws) {
+        if ((ws->bestLo == Problem::InvalidId) || (ws->bestValue < incumbent.get())) { continue; }
+        bestValue = ws->bestValue;
+        ID windowSize = ws->bestHi - ws->bestLo + 1;
+        List<int> &lefts(ws->lefts);
+        copy(residuals.begin() + ws->bestLo, residuals.begin() + ws->bestHi + 1, lefts.begin());
+        for (ID t = 0; t < k; ++t) {
+            Plan::CabinLoad &load(loads[cabins[t]]);
+            ID x = ws->bestChoices[t];
+            if (x >= windowSize) {
+                load = Plan::CabinLoad();
+                continue;
+            }
+            load.station = candidates[ws->bestLo + x];
+            load.quantity = (min)(volumes[cabins[t]], lefts[x]);
+            lefts[x] -= load.quantity;
+        }
+        break;
+    }
+
+    return remember();
+}
+
+bool Solver::localSearch(Plan &plan, Random &rng, ID period, int oracleThreadNum) {
+    List<ID> vehiclePeriods;
+    vehiclePeriods.reserve(periodNumber * vehicleNumber);
+    for (ID i = 0; i < periodNumber * vehicleNumber; ++i) {
+        if ((period == Problem::InvalidId) || (i / vehicleNumber == period)) { vehiclePeriods.push_back(i); }
+    }
+
+    List<Plan::CabinLoad> loads;
+    bool improved = false;
+    for (bool improvedInPass = true, constructing = (plan.obj <= 0); improvedInPass; constructing = false) {
+        improvedInPass = false;
+        shuffle(vehiclePeriods.begin(), vehiclePeriods.end(), rng.rgen);
+        for (auto i = vehiclePeriods.begin(); i != vehiclePeriods.end(); ++i) {
+            // finish the construction on timeout to output a complete plan, but leave at once on cancellation.
+            if (constructing ? Cancellation::isRequested() : isStopped()) { return improved; }
+
+            ID p = *i / vehicleNumber;
+            ID v = *i % vehicleNumber;
+            Revenue value = optimizeVehiclePeriod(plan, p, v, loads, oracleThreadNum);
+            if (value <= plan.vehicleValues[p][v] + Math::DefaultTolerance * Math::DefaultTolerance) { continue; }
+            assign(plan, p, v, loads);
+            improvedInPass = true;
+        }
+        improved |= improvedInPass;
+    }
+    return improved;
+}
+
+bool Solver::allocateQuantities(Plan &plan) const {
+    struct Holder {
+        ID vehicle;
+        ID cabin;
+    };
+    struct Change {
+        ID vehicle;
+        ID cabin;
+        int quantity;
+
+        bool operator<(const Change &rhs) const { return vehicle < rhs.vehicle; }
+    };
+
+    List<Change> changes;
+    List<Revenue> gains(cabinNumber); // gains[cabinOffsets[v] + c] is the marginal value of cabin c of v.
+    List<Plan::CabinLoad> loads;
+    List<Plan::CabinLoad> otherLoads;
+    List<Plan::CabinLoad> roundLoads; // the loads of the period before the current flow round.
+    Map<ID, List<Holder>> holders; // the cabins loading each station.
+    // apply the flows of a batch of stations. the quantities are cut before any is raised.
+    auto applyChanges = [&](ID p) {
+        sort(changes.begin(), changes.end());
+        for (int raise = 0; raise < 2; ++raise) {
+            for (auto c = changes.begin(); c != changes.end();) {
+                ID v = c->vehicle;
+                const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(p, v);
+                loads.assign(curLoads, curLoads + cabinNumberOf(v));
+                bool changed = false;
+                for (; (c != changes.end()) && (c->vehicle == v); ++c) {
+                    int quantity = raise ? c->quantity : (min)(c->quantity, loads[c->cabin].quantity);
+                    if (quantity == loads[c->cabin].quantity) { continue; }
+                    loads[c->cabin].quantity = quantity;
+                    if (quantity <= 0) { loads[c->cabin] = Plan::CabinLoad(); }
+                    changed = true;
+                }
+                if (changed) { assign(plan, p, v, loads); }
+            }
+        }
+        changes.clear();
+    };
+    auto collectHolders = [&](ID p) {
+        holders.clear();
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(p, v);
+            for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                if (curLoads[c].quantity > 0) { holders[curLoads[c].station].push_back({ v, c }); }
+            }
+        }
+    };
+
+    bool improved = false;
+    for (ID p = 0; p < periodNumber; ++p) {
+        // fill every cabin up with the residual demand of its station, which raises both factors.
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(p, v);
+            loads.assign(curLoads, curLoads + cabinNumberOf(v));
+            bool filled = false;
+            for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                if (loads[c].quantity <= 0) { continue; }
+                int quantity = (min)(cabinVolumes[cabinOffsets[v] + c] - loads[c].quantity, residualOf(plan, p, loads[c].station));
+                if (quantity <= 0) { continue; }
+                loads[c].quantity += quantity;
+                assign(plan, p, v, loads);
+                filled = true;
+            }
+            improved |= filled;
+        }
+
+        // maximize the tangent of the vehicle values over the demand splits. the value of a vehicle is
+        // bilinear in its quantities, so a round may lower the objective and it is undone then.
+        Revenue periodObj = plan.obj;
+        for (Revenue oldObj = -1.0; plan.obj > oldObj + Math::DefaultTolerance * Math::DefaultTolerance;) {
+            oldObj = plan.obj;
+            roundLoads.assign(plan.loads.begin() + loadIndex(p, 0), plan.loads.begin() + loadIndex(p + 1, 0));
+            collectHolders(p);
+            for (ID v = 0; v < vehicleNumber; ++v) {
+                const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(p, v);
+                double vehicleValue = 0.0;
+                int vehicleLoad = 0;
+                for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                    if (curLoads[c].quantity <= 0) { continue; }
+                    vehicleValue += curLoads[c].quantity * unitValues[p][curLoads[c].station];
+                    vehicleLoad += curLoads[c].quantity;
+                }
+                // d(value * load * loadSharing / volume) / d(quantity of cabin c).
+                double loadSharing = (vehicleValue > 0) ? (plan.vehicleValues[p][v] * vehicleVolumes[v] / (vehicleValue * vehicleLoad)) : 0.0;
+                for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                    if (curLoads[c].quantity <= 0) { continue; }
+                    gains[cabinOffsets[v] + c] = (unitValues[p][curLoads[c].station] * vehicleLoad + vehicleValue) * loadSharing / vehicleVolumes[v];
+                }
+            }
+
+            List<std::pair<Holder, int>> arcs; // the holder of each arc in the current batch.
+            auto solveBatch = [&]() {
+                transportation.solve(0, 1);
+                for (auto a = arcs.begin(); a != arcs.end(); ++a) {
+                    changes.push_back({ a->first.vehicle, a->first.cabin, transportation.flowOn(a->second) });
+                }
+                applyChanges(p);
+                arcs.clear();
+            };
+            ID nodeNum = 2; // the source and the sink.
+            transportation.clear(MaxSplitArcNum + 2);
+            for (auto h = holders.begin(); h != holders.end(); ++h) {
+                if (h->second.size() < 2) { continue; }
+                // a station with too many holders to fit in an empty network is left to the pairwise transfers.
+                if (h->second.size() + 1 > MaxSplitArcNum) { continue; }
+                if (transportation.full(static_cast<int>(h->second.size()) + 1)) {
+                    solveBatch();
+                    nodeNum = 2;
+                    transportation.clear(MaxSplitArcNum + 2);
+                }
+                ID station = nodeNum++;
+                transportation.addArc(0, station, demands[p][h->first], 0.0);
+                for (auto c = h->second.begin(); c != h->second.end(); ++c) {
+                    int volume = cabinVolumes[cabinOffsets[c->vehicle] + c->cabin];
+                    arcs.push_back({ *c, transportation.addArc(station, 1, volume, -gains[cabinOffsets[c->vehicle] + c->cabin]) });
+                }
+            }
+            if (!arcs.empty()) { solveBatch(); }
+
+            if (plan.obj >= oldObj) { continue; }
+            for (ID v = 0; v < vehicleNumber; ++v) {
+                const Plan::CabinLoad *oldLoads = roundLoads.data() + cabinOffsets[v];
+                bool same = equal(oldLoads, oldLoads + cabinNumberOf(v), plan.loads.begin() + loadIndex(p, v),
+                    [](const Plan::CabinLoad &l, const Plan::CabinLoad &r) { return (l.station == r.station) && (l.quantity == r.quantity); });
+                if (same) { continue; }
+                loads.assign(oldLoads, oldLoads + cabinNumberOf(v));
+                assign(plan, p, v, loads);
+            }
+            break;
+        }
+        improved |= (plan.obj > periodObj + Math::DefaultTolerance * Math::DefaultTolerance);
+        collectHolders(p);
+
+        // move the quantity of a station between the cabins of two vehicles as long as it pays.
+        for (bool improvedInPass = true; improvedInPass;) {
+            improvedInPass = false;
+            for (auto h = holders.begin(); h != holders.end(); ++h) {
+                for (auto to = h->second.begin(); to != h->second.end(); ++to) {
+                    for (auto from = h->second.begin(); from != h->second.end(); ++from) {
+                        if (from->vehicle == to->vehicle) { continue; }
+                        const Plan::CabinLoad *toLoads = plan.loads.data() + loadIndex(p, to->vehicle);
+                        const Plan::CabinLoad *fromLoads = plan.loads.data() + loadIndex(p, from->vehicle);
+                        int quantity = (min)(fromLoads[from->cabin].quantity, cabinVolumes[cabinOffsets[to->vehicle] + to->cabin] - toLoads[to->cabin].quantity);
+                        if ((quantity <= 0) || (toLoads[to->cabin].station != h->first)) { continue; }
+
+                        loads.assign(toLoads, toLoads + cabinNumberOf(to->vehicle));
+                        otherLoads.assign(fromLoads, fromLoads + cabinNumberOf(from->vehicle));
+                        loads[to->cabin].quantity += quantity;
+                        if ((otherLoads[from->cabin].quantity -= quantity) <= 0) { otherLoads[from->cabin] = Plan::CabinLoad(); }
+                        Revenue delta = vehiclePeriodValue(p, to->vehicle, loads.data()) - plan.vehicleValues[p][to->vehicle]
+                            + vehiclePeriodValue(p, from->vehicle, otherLoads.data()) - plan.vehicleValues[p][from->vehicle];
+                        if (delta <= Math::DefaultTolerance * Math::DefaultTolerance) { continue; }
+                        assign(plan, p, from->vehicle, otherLoads);
+                        assign(plan, p, to->vehicle, loads);
+                        improvedInPass = true;
+                    }
+                }
+            }
+            improved |= improvedInPass;
+        }
+    }
+    return improved;
+}
+
+bool Solver::reassignStation(Plan &plan, Random &rng) {
+    // move a served station to a period where it is worth more.
+    ID station = rng.pick(stationNumber);
+    ID srcPeriod = plan.stationPeriods[station];
+    if (srcPeriod == Problem::InvalidId) { return false; }
+    ID dstPeriod = Problem::InvalidId;
+    for (ID r = 0; (r < periodNumber) && (periodRankings[station][r] != srcPeriod); ++r) {
+        if (!candidateStations[periodRankings[station][r]].test(station)) { continue; }
+        if (rng.isPicked(1, 2) || (dstPeriod == Problem::InvalidId)) { dstPeriod = periodRankings[station][r]; }
+    }
+    if (dstPeriod == Problem::InvalidId) { return false; }
+
+    // only the two periods change, so their loads are kept to undo the move.
+    List<ID> periods({ srcPeriod, dstPeriod });
+    List<Plan::CabinLoad> oldLoads;
+    for (auto p = periods.begin(); p != periods.end(); ++p) {
+        oldLoads.insert(oldLoads.end(), plan.loads.begin() + loadIndex(*p, 0), plan.loads.begin() + loadIndex(*p + 1, 0));
+    }
+    Revenue oldObj = plan.obj;
+
+    // the source period gives up the station and may take free stations instead. the destination
+    // period takes the station only, so that the two periods never compete for the same station.
+    // the workers already occupy the cores, so the two periods are solved one after the other.
+    releaseStation(plan, srcPeriod, station);
+    blockStation(plan, srcPeriod, station);
+    localSearch(plan, rng, srcPeriod);
+    unblockStation(plan, srcPeriod, station);
+
+    const Bitset &free(plan.freeStations);
+    const Bitset &unmet(plan.unmetStations[dstPeriod]);
+    List<ID> freeStations;
+    Bitset::enumerate(free.words(), [&](int w) { return free.word(w) & unmet.word(w); }, [&](int s) {
+        if (s != station) { freeStations.push_back(s); }
+    });
+    for (auto s = freeStations.begin(); s != freeStations.end(); ++s) { blockStation(plan, dstPeriod, *s); }
+    localSearch(plan, rng, dstPeriod);
+    for (auto s = freeStations.begin(); s != freeStations.end(); ++s) { unblockStation(plan, dstPeriod, *s); }
+
+    if (plan.obj > oldObj + Math::DefaultTolerance * Math::DefaultTolerance) { return true; }
+
+    // the destination period is restored first to give the station back to the source period.
+    List<Plan::CabinLoad> loads;
+    for (size_t i = periods.size(); i-- > 0;) {
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            const Plan::CabinLoad *restoredLoads = oldLoads.data() + i * cabinNumber + cabinOffsets[v];
+            loads.assign(restoredLoads, restoredLoads + cabinNumberOf(v));
+            assign(plan, periods[i], v, loads);
+        }
+    }
+    return false;
+}
+
+bool Solver::ejectStations(Plan &plan, Random &rng) {
+    ID station = rng.pick(stationNumber);
+    ID period = plan.stationPeriods[station];
+    if (period == Problem::InvalidId) { return false; }
+
+    // every assignment is logged so that a failed chain can be rolled back.
+    List<LoadChange> changes;
+
+    struct Trial {
+        ID vehicle;
+        ID distance; // from the station to the window of the vehicle.
+    };
+    List<Trial> trials;
+    trials.reserve(vehicleNumber);
+    List<Plan::CabinLoad> loads;
+    List<Plan::CabinLoad> bestLoads;
+    List<pair<ID, ID>> blockedStations; // (period, station).
+    Revenue oldObj = plan.obj;
+    bool improved = false;
+    for (ID depth = 0; !improved && (depth < cfg.ejectionChainDepth) && !isStopped(); ++depth) {
+        // the station leaves its period for good, so the vehicles there fill up without it.
+        List<ID> holders;
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(period, v);
+            for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                if ((curLoads[c].quantity <= 0) || (curLoads[c].station != station)) { continue; }
+                loads.assign(curLoads, curLoads + cabinNumberOf(v));
+                for (auto l = loads.begin(); l != loads.end(); ++l) {
+                    if (l->station == station) { *l = Plan::CabinLoad(); }
+                }
+                assign(plan, period, v, loads, changes);
+                holders.push_back(v);
+                break;
+            }
+        }
+        blockStation(plan, period, station);
+        blockedStations.push_back({ period, station });
+        for (auto v = holders.begin(); v != holders.end(); ++v) {
+            if (optimizeVehiclePeriod(plan, period, *v, loads) > plan.vehicleValues[period][*v]) { assign(plan, period, *v, loads, changes); }
+        }
+
+        // insert the station into the vehicle gaining the most in another period. only the vehicles
+        // closest to it are tried since the oracle is much more expensive than the delta evaluation.
+        ID bestPeriod = Problem::InvalidId;
+        ID bestVehicle = Problem::InvalidId;
+        Revenue bestGain = -(numeric_limits<Revenue>::max)();
+        for (ID p = 0; p < periodNumber; ++p) {
+            if ((p == period) || !plan.unmetStations[p].test(station)) { continue; }
+            trials.clear();
+            bool idleTried = false;
+            for (ID v = 0; v < vehicleNumber; ++v) {
+                const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(p, v);
+                ID minStationId = stationNumber;
+                ID maxStationId = Problem::InvalidId;
+                for (ID c = 0; c < cabinNumberOf(v); ++c) {
+                    if (curLoads[c].quantity <= 0) { continue; }
+                    minStationId = (min)(minStationId, curLoads[c].station);
+                    maxStationId = (max)(maxStationId, curLoads[c].station);
+                }
+                if (maxStationId == Problem::InvalidId) {
+                    if (idleTried) { continue; }
+                    idleTried = true;
+                    trials.push_back({ v, stationNumber });
+                } else {
+                    trials.push_back({ v, (max)(0, (max)(minStationId - station, station - maxStationId)) });
+                }
+            }
+            ID trialNum = (min)(static_cast<ID>(trials.size()), cfg.ejectionTrialNum);
+            partial_sort(trials.begin(), trials.begin() + trialNum, trials.end(), [](const Trial &l, const Trial &r) {
+                return l.distance < r.distance;
+            });
+            for (auto t = trials.begin(); t != trials.begin() + trialNum; ++t) {
+                Revenue gain = optimizeVehiclePeriod(plan, p, t->vehicle, loads) - plan.vehicleValues[p][t->vehicle];
+                if (gain <= bestGain) { continue; }
+                if (none_of(loads.begin(), loads.end(), [&](const Plan::CabinLoad &l) {
+                    return (l.quantity > 0) && (l.station == station);
+                })) { continue; }
+                bestPeriod = p;
+                bestVehicle = t->vehicle;
+                bestGain = gain;
+                swap(bestLoads, loads);
+            }
+        }
+        if (bestVehicle == Problem::InvalidId) { break; }
+
+        // the stations the vehicle gives up entirely are ejected, and one of them continues the chain.
+        const Plan::CabinLoad *oldLoads = plan.loads.data() + loadIndex(bestPeriod, bestVehicle);
+        List<ID> droppedStations;
+        for (ID c = 0; c < cabinNumberOf(bestVehicle); ++c) {
+            if (oldLoads[c].quantity > 0) { droppedStations.push_back(oldLoads[c].station); }
+        }
+        assign(plan, bestPeriod, bestVehicle, bestLoads, changes);
+        improved = (plan.obj > oldObj + Math::DefaultTolerance * Math::DefaultTolerance);
+
+        station = Problem::InvalidId;
+        for (auto s = droppedStations.begin(); s != droppedStations.end(); ++s) {
+            if (plan.deliveredQuantities[bestPeriod][*s] > 0) { continue; }
+            if ((station == Problem::InvalidId) || rng.isPicked(1, 2)) { station = *s; }
+        }
+        if (station == Problem::InvalidId) { break; }
+        period = bestPeriod;
+    }
+
+    // unblock before rolling back so that the restored loads reset the availability of the stations.
+    for (auto b = blockedStations.rbegin(); b != blockedStations.rend(); ++b) { unblockStation(plan, b->first, b->second); }
+    if (improved) { return true; }
+    rollback(plan, changes);
+    return false;
+}
+
+void Solver::construct(Plan &plan, const function<size_t(const List<Insertion>&)> &pick) const {
+    List<Insertion> insertions;
+    insertions.reserve(periodNumber * vehicleNumber);
+    for (ID i = 0; i < periodNumber * vehicleNumber; ++i) {
+        if (plan.vehicleValues[i / vehicleNumber][i % vehicleNumber] <= 0) { insertions.push_back({ i, false, 0.0, {} }); }
+    }
+
+    // as the residual demands never increase during construction, an insertion stays optimal until a station
+    // it loads is touched, and the worthless insertions can be dropped for good.
+    List<bool> touchedStations(stationNumber, false);
+    while (!insertions.empty() && !Cancellation::isRequested()) {
+        for (auto i = insertions.begin(); i != insertions.end();) {
+            if (!i->valid) {
+                i->value = optimizeVehiclePeriod(plan, i->vehiclePeriod / vehicleNumber, i->vehiclePeriod % vehicleNumber, i->loads);
+                i->valid = true;
+            }
+            if (i->value > 0) {
+                ++i;
+            } else {
+                *i = move(insertions.back());
+                insertions.pop_back();
+            }
+        }
+        if (insertions.empty()) { break; }
+
+        auto picked = insertions.begin() + pick(insertions);
+        assign(plan, picked->vehiclePeriod / vehicleNumber, picked->vehiclePeriod % vehicleNumber, picked->loads);
+        for (auto l = picked->loads.begin(); l != picked->loads.end(); ++l) {
+            if (l->quantity > 0) { touchedStations[l->station] = true; }
+        }
+        *picked = move(insertions.back());
+        insertions.pop_back();
+
+        for (auto i = insertions.begin(); i != insertions.end(); ++i) {
+            i->valid = none_of(i->loads.begin(), i->loads.end(), [&](const Plan::CabinLoad &l) {
+                return (l.quantity > 0) && touchedStations[l.station];
+            });
+        }
+        fill(touchedStations.begin(), touchedStations.end(), false);
+    }
+}
+
+void Solver::constructGreedily(Plan &plan, double alpha, Random &rng) const {
+    construct(plan, [&](const List<Insertion> &insertions) {
+        Revenue maxValue = 0.0;
+        Revenue minValue = (numeric_limits<Revenue>::max)();
+        for (auto i = insertions.begin(); i != insertions.end(); ++i) {
+            maxValue = (max)(maxValue, i->value);
+            minValue = (min)(minValue, i->value);
+        }
+
+        Revenue threshold = maxValue - alpha * (maxValue - minValue);
+        Sampling sampler(rng, 1);
+        size_t picked = 0;
+        for (size_t i = 0; i < insertions.size(); ++i) {
+            if ((insertions[i].value >= threshold) && sampler.isPicked()) { picked = i; }
+        }
+        return picked;
+    });
+}
+
+void Solver::constructByAnt(Plan &plan, const Pheromone &pheromone, Random &rng) const {
+    List<double> weights;
+    construct(plan, [&](const List<Insertion> &insertions) {
+        // the attractiveness is the value of the insertion, and the trail combines the window start of
+        // the vehicle with the mean trail of the stations in the period.
+        weights.resize(insertions.size());
+        double totalWeight = 0.0;
+        for (size_t i = 0; i < insertions.size(); ++i) {
+            ID p = insertions[i].vehiclePeriod / vehicleNumber;
+            ID v = insertions[i].vehiclePeriod % vehicleNumber;
+            ID windowStart = stationNumber;
+            double stationTrail = 0.0;
+            int loadNum = 0;
+            for (auto l = insertions[i].loads.begin(); l != insertions[i].loads.end(); ++l) {
+                if (l->quantity <= 0) { continue; }
+                windowStart = (min)(windowStart, l->station);
+                stationTrail += pheromone.stationPeriod(l->station, p);
+                ++loadNum;
+            }
+            double trail = pheromone.vehicleWindow(v, windowStart) * stationTrail / loadNum;
+            weights[i] = trail * pow(insertions[i].value, cfg.antBeta);
+            totalWeight += weights[i];
+        }
+
+        double r = totalWeight * rng() / (static_cast<double>((Random::Generator::max)()) + 1);
+        for (size_t i = 0; i < insertions.size(); ++i) {
+            if ((r -= weights[i]) < 0) { return i; }
+        }
+        return insertions.size() - 1;
+    });
+}
+
+bool Solver::resolvePairs(Plan &plan, Random &rng) {
+    List<VehiclePeriodPair> pairs;
+    overlappingPairs(plan, pairs, rng);
+
+    int threadNum = (max)(1, cfg.threadNumPerWorker);
+    List<Plan> pairPlans(threadNum);
+    List<List<LoadChange>> pairChanges(threadNum);
+    List<bool> pairImproved(threadNum);
+    List<VehiclePeriodPair> batch;
+    List<bool> used(periodNumber * vehicleNumber);
+    List<Plan::CabinLoad> loads;
+    bool improved = false;
+    for (auto i = pairs.begin(); (i != pairs.end()) && !isStopped();) {
+        batch.clear();
+        fill(used.begin(), used.end(), false);
+        for (; (i != pairs.end()) && (static_cast<int>(batch.size()) < threadNum); ++i) {
+            ID a = i->periods[0] * vehicleNumber + i->vehicles[0];
+            ID b = i->periods[1] * vehicleNumber + i->vehicles[1];
+            if (used[a] || used[b]) { break; }
+            used[a] = used[b] = true;
+            batch.push_back(*i);
+        }
+
+        if (threadNum == 1) {
+            pairChanges[0].clear();
+            improved |= resolvePair(plan, batch[0], pairChanges[0]);
+            continue;
+        }
+
+        ThreadTeam::local().run(static_cast<int>(batch.size()), [&](int t) {
+            pairPlans[t] = plan;
+            pairChanges[t].clear();
+            pairImproved[t] = resolvePair(pairPlans[t], batch[t], pairChanges[t]);
+        });
+
+        // the pairs may compete for the same free stations, so each one is checked again on merging.
+        List<LoadChange> changes;
+        for (size_t t = 0; t < batch.size(); ++t) {
+            if (!pairImproved[t]) { continue; }
+            Revenue oldObj = plan.obj;
+            bool assignable = true;
+            for (int k = 0; assignable && (k < 2); ++k) {
+                ID p = batch[t].periods[k];
+                ID v = batch[t].vehicles[k];
+                const Plan::CabinLoad *newLoads = pairPlans[t].loads.data() + loadIndex(p, v);
+                loads.assign(newLoads, newLoads + cabinNumberOf(v));
+                if ((assignable = isAssignable(plan, p, v, loads))) { assign(plan, p, v, loads, changes); }
+            }
+            if (assignable && (plan.obj > oldObj + Math::DefaultTolerance * Math::DefaultTolerance)) {
+                improved = true;
+                changes.clear();
+            } else {
+                rollback(plan, changes);
+            }
+        }
+    }
+    return improved;
+}
+
+bool Solver::resolvePair(Plan &plan, const VehiclePeriodPair &pair, List<LoadChange> &changes) const {
+    ID periods[2] = { pair.periods[0], pair.periods[1] };
+    ID vehicles[2] = { pair.vehicles[0], pair.vehicles[1] };
+    Revenue oldValue = plan.vehicleValues[periods[0]][vehicles[0]] + plan.vehicleValues[periods[1]][vehicles[1]];
+
+    List<Plan::CabinLoad> loads;
+    for (int k = 0; k < 2; ++k) {
+        loads.assign(cabinNumberOf(vehicles[k]), Plan::CabinLoad());
+        assign(plan, periods[k], vehicles[k], loads, changes);
+    }
+
+    // each vehicle-period is solved exactly given the other one. alternate until neither improves,
+    // starting from each of the two, and keep the better fixed point.
+    Revenue bestValue = oldValue + Math::DefaultTolerance * Math::DefaultTolerance;
+    List<Plan::CabinLoad> bestLoads[2];
+    List<LoadChange> orderChanges;
+    for (int first = 0; first < 2; ++first) {
+        for (int k = first, stableNum = 0; stableNum < 2; k = 1 - k) {
+            Revenue value = optimizeVehiclePeriod(plan, periods[k], vehicles[k], loads);
+            if (value > plan.vehicleValues[periods[k]][vehicles[k]] + Math::DefaultTolerance * Math::DefaultTolerance) {
+                assign(plan, periods[k], vehicles[k], loads, orderChanges);
+                stableNum = 0;
+            }
+            ++stableNum;
+        }
+        Revenue value = plan.vehicleValues[periods[0]][vehicles[0]] + plan.vehicleValues[periods[1]][vehicles[1]];
+        if (value > bestValue) {
+            bestValue = value;
+            for (int k = 0; k < 2; ++k) {
+                const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(periods[k], vehicles[k]);
+                bestLoads[k].assign(curLoads, curLoads + cabinNumberOf(vehicles[k]));
+            }
+        }
+        rollback(plan, orderChanges);
+    }
+
+    if (bestLoads[0].empty()) {
+        rollback(plan, changes);
+        return false;
+    }
+    for (int k = 0; k < 2; ++k) { assign(plan, periods[k], vehicles[k], bestLoads[k], changes); }
+    return true;
+}
+
+void Solver::overlappingPairs(const Plan &plan, List<VehiclePeriodPair> &pairs, Random &rng) const {
+    struct Window {
+        ID period;
+        ID vehicle;
+        ID minStationId;
+        ID maxStationId;
+    };
+    List<Window> windows;
+    windows.reserve(periodNumber * vehicleNumber);
+    for (ID p = 0; p < periodNumber; ++p) {
+        for (ID v = 0; v < vehicleNumber; ++v) {
+            Window w = { p, v, stationNumber, Problem::InvalidId };
+            windowOf(plan, p, v, w.minStationId, w.maxStationId);
+            if (w.maxStationId != Problem::InvalidId) { windows.push_back(w); }
+        }
+    }
+
+    // sweep the windows in increasing start. the two vehicle-periods are in the same period or of the same vehicle.
+    sort(windows.begin(), windows.end(), [](const Window &l, const Window &r) { return l.minStationId < r.minStationId; });
+    pairs.clear();
+    for (auto l = windows.begin(); l != windows.end(); ++l) {
+        for (auto r = l + 1; (r != windows.end()) && (r->minStationId <= l->maxStationId); ++r) {
+            if ((l->period != r->period) && (l->vehicle != r->vehicle)) { continue; }
+            ID overlap = (min)(l->maxStationId, r->maxStationId) - r->minStationId;
+            pairs.push_back({ { l->period, r->period }, { l->vehicle, r->vehicle }, overlap });
+        }
+    }
+    shuffle(pairs.begin(), pairs.end(), rng.rgen);
+    stable_sort(pairs.begin(), pairs.end(), [](const VehiclePeriodPair &l, const VehiclePeriodPair &r) {
+        return l.overlap > r.overlap;
+    });
+}
+
+bool Solver::variableNeighborhoodDescent(Plan &plan, Random &rng) {
+    // the neighborhoods in increasing cost. the randomized ones are tried from a few random starts.
+    // allocateQuantities() is left to the final polish since its flow rounds cost more than they gain here.
+    // the oracle of the first one may use all threads of the worker, except in deterministic mode where
+    // the threads would break ties between equally good loads in arbitrary order.
+    int oracleThreadNum = cfg.deterministic ? 1 : cfg.threadNumPerWorker;
+    List<function<bool()>> neighborhoods({
+        [&]() { return localSearch(plan, rng, Problem::InvalidId, oracleThreadNum); },
+        [&]() { return shiftLoads(plan, rng); },
+        [&]() {
+            for (int i = 0; (i < cfg.vndAttemptNum) && !isStopped(); ++i) { if (reassignStation(plan, rng)) { return true; } }
+            return false;
+        },
+        [&]() {
+            for (int i = 0; (i < cfg.vndAttemptNum) && !isStopped(); ++i) { if (ejectStations(plan, rng)) { return true; } }
+            return false;
+        },
+    });
+
+    bool improved = false;
+    for (size_t k = 0; (k < neighborhoods.size()) && !isStopped();) {
+        if (neighborhoods[k]()) {
+            improved = true;
+            k = (k > 0) ? 0 : 1; // the first neighborhood is already exhausted.
+        } else {
+            ++k;
+        }
+    }
+    return improved;
+}
+
+void Solver::blockStation(Plan &plan, ID period, ID station) const {
+    trackResiduals(plan, station, -1);
+    plan.unmetStations[period].reset(station);
+    trackResiduals(plan, station, 1);
+}
+
+void Solver::unblockStation(Plan &plan, ID period, ID station) const {
+    if (!candidateStations[period].test(station) || (plan.deliveredQuantities[period][station] >= demands[period][station])) { return; }
+    trackResiduals(plan, station, -1);
+    plan.unmetStations[period].set(station);
+    trackResiduals(plan, station, 1);
+}
+
+void Solver::releaseStation(Plan &plan, ID period, ID station, List<LoadChange> *changes) const {
+    List<Plan::CabinLoad> loads;
+    for (ID v = 0; (plan.deliveredQuantities[period][station] > 0) && (v < vehicleNumber); ++v) {
+        const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(period, v);
+        loads.assign(curLoads, curLoads + cabinNumberOf(v));
+        bool released = false;
+        for (auto l = loads.begin(); l != loads.end(); ++l) {
+            if ((l->quantity <= 0) || (l->station != station)) { continue; }
+            *l = Plan::CabinLoad();
+            released = true;
+        }
+        if (!released) { continue; }
+        if (changes != nullptr) {
+            assign(plan, period, v, loads, *changes);
+        } else {
+            assign(plan, period, v, loads);
+        }
+    }
+}
+
+void Solver::perturb(Plan &plan, ID vehicleNum, Random &rng) {
+    ID period = rng.pick(periodNumber);
+    List<ID> vehicles(vehicleNumber);
+    for (ID v = 0; v < vehicleNumber; ++v) { vehicles[v] = v; }
+    shuffle(vehicles.begin(), vehicles.end(), rng.rgen);
+
+    List<Plan::CabinLoad> loads;
+    for (ID i = 0; i < vehicleNum; ++i) {
+        loads.assign(cabinNumberOf(vehicles[i]), Plan::CabinLoad());
+        assign(plan, period, vehicles[i], loads);
+    }
+}
+
+bool Solver::markSeen(Hash::Key planHash) {
+    // the plans of the other workers arrive at moments depending on the thread timing.
+    if (cfg.deterministic) { return true; }
+    lock_guard<mutex> seenPlanGuard(seenPlanMutex);
+    return seenPlans.insert(planHash);
+}
+
+bool Solver::shiftLoads(Plan &plan, Random &rng) {
+    List<ID> vehiclePeriods(periodNumber * vehicleNumber);
+    for (ID i = 0; i < periodNumber * vehicleNumber; ++i) { vehiclePeriods[i] = i; }
+    shuffle(vehiclePeriods.begin(), vehiclePeriods.end(), rng.rgen);
+
+    MoveBatch moves;
+    List<ID> order;
+    List<Plan::CabinLoad> loads;
+    List<Plan::CabinLoad> donorLoads;
+    List<std::pair<ID, List<Plan::CabinLoad>>> donors; // the new loads of the vehicles giving up demand.
+    bool improved = false;
+    for (auto i = vehiclePeriods.begin(); i != vehiclePeriods.end(); ++i) {
+        if (isStopped()) { break; }
+
+        ID p = *i / vehicleNumber;
+        ID v = *i % vehicleNumber;
+        ID k = cabinNumberOf(v);
+        const Plan::CabinLoad *curLoads = plan.loads.data() + loadIndex(p, v);
+        ID minStationId = stationNumber;
+        ID maxStationId = Problem::InvalidId;
+        for (ID c = 0; c < k; ++c) {
+            if (curLoads[c].quantity <= 0) { continue; }
+            minStationId = (min)(minStationId, curLoads[c].station);
+            maxStationId = (max)(maxStationId, curLoads[c].station);
+        }
+        if (maxStationId < 0) { continue; }
+
+        // every cabin to every station available in this period around the window with the max quantity.
+        const Bitset &candidates(candidateStations[p]);
+        const Bitset &served(plan.servedStations[p]);
+        const Bitset &free(plan.freeStations);
+        moves.clear();
+        Bitset::enumerate(candidates.words(), [&](int w) { return (free.word(w) | served.word(w)) & candidates.word(w); }, [&](int s) {
+            for (ID c = 0; c < k; ++c) {
+                int quantity = demands[p][s];
+                for (ID other = 0; other < k; ++other) {
+                    if ((other != c) && (curLoads[other].station == s)) { quantity -= curLoads[other].quantity; }
+                }
+                quantity = (min)(quantity, cabinVolumes[cabinOffsets[v] + c]);
+                if ((quantity <= 0) || ((curLoads[c].station == s) && (curLoads[c].quantity == quantity))) { continue; }
+                moves.add(c, s, quantity);
+            }
+        }, (max)(0, minStationId - k), (min)(stationNumber - 1, maxStationId + k));
+        for (ID c = 0; c < k; ++c) {
+            if (curLoads[c].quantity > 0) { moves.add(c, Problem::InvalidId, 0); }
+        }
+        evaluateMoves(plan, p, v, moves);
+
+        order.clear();
+        for (ID m = 0; m < moves.size(); ++m) {
+            if (moves.deltas[m] > Math::DefaultTolerance * Math::DefaultTolerance) { order.push_back(m); }
+        }
+        sort(order.begin(), order.end(), [&](ID l, ID r) { return moves.deltas[l] > moves.deltas[r]; });
+
+        // take the first move which still improves after the other vehicles give up the missing demand.
+        for (auto m = order.begin(); m != order.end(); ++m) {
+            ID c = moves.cabins[*m];
+            ID s = moves.stations[*m];
+            int quantity = moves.quantities[*m];
+            Revenue delta = moves.deltas[*m];
+            donors.clear();
+            int deficit = (s < 0) ? 0 : (quantity - residualOf(plan, p, s) - ((curLoads[c].station == s) ? curLoads[c].quantity : 0));
+            for (ID u = 0; (deficit > 0) && (u < vehicleNumber); ++u) {
+                if (u == v) { continue; }
+                const Plan::CabinLoad *uLoads = plan.loads.data() + loadIndex(p, u);
+                donorLoads.assign(uLoads, uLoads + cabinNumberOf(u));
+                bool donated = false;
+                for (auto l = donorLoads.begin(); (deficit > 0) && (l != donorLoads.end()); ++l) {
+                    if ((l->quantity <= 0) || (l->station != s)) { continue; }
+                    int cut = (min)(deficit, l->quantity);
+                    deficit -= cut;
+                    if ((l->quantity -= cut) <= 0) { *l = Plan::CabinLoad(); }
+                    donated = true;
+                }
+                if (!donated) { continue; }
+                delta += vehiclePeriodValue(p, u, donorLoads.data()) - plan.vehicleValues[p][u];
+                donors.push_back(std::make_pair(u, donorLoads));
+            }
+            if (delta <= Math::DefaultTolerance * Math::DefaultTolerance) { continue; }
+
+            for (auto d = donors.begin(); d != donors.end(); ++d) { assign(plan, p, d->first, d->second); }
+            loads.assign(curLoads, curLoads + k);
+            loads[c].station = s;
+            loads[c].quantity = quantity;
+            assign(plan, p, v, loads);
+            improved = true;
+            break;
+        }
+    }
+    return improved;
 }
 #pragma endregion Solver
 
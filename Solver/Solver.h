@@ -11,13 +11,28 @@
 #include "Config.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <thread>
 
 #include "Common.h"
+#include "Bitset.h"
+#include "CsvReader.h"
+#include "FenwickTree.h"
+#include "MinCostFlow.h"
+#include "Pheromone.h"
+#include "Racing.h"
+#include "ShardedCache.h"
+#include "SpscRing.h"
+#include "TabuSet.h"
+#include "ThreadTeam.h"
 #include "Utility.h"
+#include "WindowBound.h"
+#include "WorkStealing.h"
 #include "LogSwitch.h"
 #include "Problem.h"
 
@@ -42,6 +57,7 @@ public:
         static String EnvironmentPathOption() { return "-env"; }
         static String ConfigPathOption() { return "-cfg"; }
         static String LogPathOption() { return "-log"; }
+        static String InitSolutionPathOption() { return "-init"; }
 
         static String AuthorNameSwitch() { return "-name"; }
         static String HelpSwitch() { return "-h"; }
@@ -51,7 +67,7 @@ public:
             return "Pattern (args can be in any order):\n"
                 "  exe (-p path) (-o path) [-s int] [-t seconds] [-name]\n"
                 "      [-iter int] [-j int] [-id string] [-h]\n"
-                "      [-env path] [-cfg path] [-log path]\n"
+                "      [-env path] [-cfg path] [-log path] [-init path]\n"
                 "Switches:\n"
                 "  -name  return the identifier of the authors.\n"
                 "  -h     print help information.\n"
@@ -66,6 +82,7 @@ public:
                 "  -env   environment file path.\n"
                 "  -cfg   configuration file path.\n"
                 "  -log   activate logging and specify log file path.\n"
+                "  -init  warm start from a solution file in the output format.\n"
                 "Note:\n"
                 "  0. in pattern, () is non-optional group, [] is optional group\n"
                 "     when -env option is not given.\n"
@@ -76,7 +93,10 @@ public:
                 "     for a long time. so you should set at least one of them.\n"
                 "  3. the solver will still try to generate an initial solution\n"
                 "     even if the timeout or max iteration is 0. but the solution\n"
-                "     is not guaranteed to be feasible.\n";
+                "     is not guaranteed to be feasible.\n"
+                "  4. with deterministic;1 in the -cfg file, only iter ends the run\n"
+                "     normally. timeout kills the run wherever it is, and the\n"
+                "     output of a killed run is not reproducible.\n";
         }
 
         // a dummy main function.
@@ -85,7 +105,9 @@ public:
 
     // controls the I/O data format, exported contents and general usage of the solver.
     struct Configuration {
-        enum Algorithm { Greedy, TreeSearch, DynamicProgramming, LocalSearch, Genetic, MathematicallProgramming };
+        enum Algorithm { Greedy, TreeSearch, DynamicProgramming, LocalSearch, Genetic, MathematicallProgramming, Grasp, AntColony };
+        // the workers to which each worker sends its best plan in the island model.
+        enum Topology { Isolated, Ring, Complete };
 
 
         Configuration() {}
@@ -103,8 +125,35 @@ public:
         }
 
 
-        Algorithm alg = Configuration::Algorithm::Greedy; // OPTIMIZE[lcg][3]: make it a list to specify a series of algorithms to be used by each threads in sequence.
+        Algorithm alg = Configuration::Algorithm::LocalSearch; // OPTIMIZE[lcg][3]: make it a list to specify a series of algorithms to be used by each threads in sequence.
         int threadNumPerWorker = (std::min)(1, static_cast<int>(std::thread::hardware_concurrency()));
+        int oracleCacheSize = (1 << 16); // the max number of cached oracle results.
+        int parallelOracleCandidateNum = 128; // the oracle searches the windows by work stealing if there are more candidates.
+        int tabuTenure = 64; // the number of recent local optima to avoid in the iterated local search. 0 disables it.
+        int seenPlanNum = 1024; // the number of recent local optima of all workers to skip. 0 disables it.
+        int ejectionChainDepth = 3; // the max number of stations moved by an ejection chain.
+        int ejectionTrialNum = 3; // the number of vehicles tried to take each station in an ejection chain.
+        int vndAttemptNum = 4; // the number of random starts of the randomized neighborhoods in each round of vnd.
+        double graspAlpha = 0.3; // the restricted candidate list keeps insertions within alpha of the best one relative to the value range.
+        int antNum = 8; // the number of ants built between two pheromone updates.
+        double antBeta = 2.0; // the exponent of the insertion value against the pheromone trail.
+        double evaporationRate = 0.1;
+        double relinkTimeRatio = 0.1; // the share of the time left to path relinking at the end if there are multiple workers.
+        int relinkSampleNum = 8; // the number of moves evaluated in each step of path relinking.
+        double targetGap = 0.0; // stop once the relative gap to the upper bound is no more than it.
+        double reoptimizeTimeout = 1.0; // the seconds for re-optimizing a plan in reoptimize().
+        Topology islandTopology = Topology::Isolated;
+        double migrationInterval = 2.0; // the seconds between two migrations from each island.
+        // reproducible runs. the workers exchange plans at the barriers between epochs and the run ends by -i or
+        // targetGap, so the output only depends on the input, the seed and the job number. -t is only a hard kill.
+        bool deterministic = false;
+        int epochIterNum = 16; // the number of engine iterations of each worker in an epoch.
+        // race the configurations from raceConfigurations() on env.jobNum threads and keep the best result.
+        bool racing = false;
+        int raceSliceIterNum = 8; // the number of engine iterations of each contestant between two yields.
+        int raceMinRoundNum = 5; // the number of rounds before the first elimination.
+        // replace alg and the engine parameters by the choice of configureByFeatures() in init().
+        bool autoConfigure = false;
     };
 
     // describe the requirements to the input and output data interface.
@@ -166,6 +215,7 @@ public:
         String rid; // the id of each run.
         String cfgPath;
         String logPath;
+        String initSlnPath; // repaired and used as the initial solution of every worker if not empty.
 
         // auto-generated data.
         String localTime;
@@ -176,17 +226,112 @@ public:
 
         Solver *solver;
     };
+
+    // new demand and value of a station in a period.
+    struct DemandUpdate {
+        ID station;
+        ID period;
+        int demand;
+        int value;
+    };
+
+    // compact delivery plan indexed by consecutive ids for searching.
+    struct Plan {
+        struct CabinLoad {
+            ID station = Problem::InvalidId;
+            int quantity = 0;
+        };
+
+        List<CabinLoad> loads; // loads[period * cabinNumber + cabinOffsets[vehicle] + cabin].
+        Arr2D<int> deliveredQuantities; // deliveredQuantities[period][station].
+        List<ID> stationPeriods; // the period in which each station is served, or InvalidId.
+        List<Bitset> servedStations; // servedStations[period] has the stations with delivered quantities.
+        Bitset freeStations; // the stations not served in any period.
+        List<Bitset> unmetStations; // unmetStations[period] has the stations with residual demand.
+        // the residual demand and its value of the stations available in each period by station id.
+        List<FenwickTree<int>> residualDemands;
+        List<FenwickTree<double>> residualValues;
+        List<Hash::Key> residualHashes; // the xor of residualKey() of the stations with residual demand in each period.
+        Hash::Key hash = 0; // the xor of loadKey() of all loads, which identifies the plan.
+        Arr2D<Revenue> vehicleValues; // vehicleValues[period][vehicle].
+        Revenue obj = 0.0;
+    };
+
+    // the oracle result for a period, a vehicle class and the residual demands it sees.
+    struct OracleResult {
+        Revenue value = 0.0;
+        List<Plan::CabinLoad> loads; // loads[t] is the load of the t_th cabin in cabinOrders.
+    };
+
+    // moves of single cabins of a vehicle-period in structure of arrays.
+    struct MoveBatch {
+        void clear() {
+            cabins.clear();
+            stations.clear();
+            quantities.clear();
+        }
+        void add(ID cabin, ID station, int quantity) {
+            cabins.push_back(cabin);
+            stations.push_back(station);
+            quantities.push_back(quantity);
+        }
+        ID size() const { return static_cast<ID>(cabins.size()); }
+
+        List<ID> cabins;
+        List<ID> stations; // InvalidId to leave the cabin idle.
+        List<int> quantities;
+        List<Revenue> deltas; // the value change of the vehicle-period.
+    };
+
+    // the oracle result of an idle vehicle-period during construction.
+    struct Insertion {
+        ID vehiclePeriod;
+        bool valid; // the value is up to date.
+        Revenue value;
+        List<Plan::CabinLoad> loads;
+    };
+
+    // two vehicle-periods re-solved together while the rest of the plan is fixed. they are either two
+    // vehicles in the same period or the same vehicle in two periods.
+    struct VehiclePeriodPair {
+        ID periods[2];
+        ID vehicles[2];
+        ID overlap; // the number of station ids shared by the windows minus 1.
+    };
+
+    // the loads of a vehicle-period before an assignment, to undo it.
+    struct LoadChange {
+        ID period;
+        ID vehicle;
+        List<Plan::CabinLoad> loads;
+    };
+
+    // summary statistics of the input to choose the engine and its parameters by.
+    struct InstanceFeatures {
+        ID stationNum;
+        ID vehicleNum;
+        ID periodNum;
+        double meanCabinNum; // the mean number of cabins of a vehicle.
+        double meanCabinVolume;
+        double cabinVolumeCv; // the coefficient of variation of the cabin volumes.
+        double demandCapacityRatio; // the mean ratio of the total demand in a period to the total vehicle volume.
+        double valueDispersion; // the coefficient of variation of the unit values of all demands.
+        double periodValueVariance; // the variance of the total demand values of the periods over their squared mean.
+    };
     #pragma endregion Type
 
     #pragma region Constant
 public:
+    static constexpr int MaxSplitArcNum = 500; // the arcs of a transportation network splitting the station demands.
+    using Transportation = MinCostFlow<MaxSplitArcNum + 2, MaxSplitArcNum>;
     #pragma endregion Constant
 
     #pragma region Constructor
 public:
     Solver(const Problem::Input &inputData, const Environment &environment, const Configuration &config)
         : input(inputData), env(environment), cfg(config), rand(environment.randSeed),
-        timer(std::chrono::milliseconds(environment.msTimeout)), iteration(1) {}
+        timer(std::chrono::milliseconds(environment.msTimeout)), engineTimer(timer),
+        parallelOracleNum(0), stealNum(0), branchNodeNum(0), busiestBranchNodeNum(0), stopped(false), iteration(1) {}
     #pragma endregion Constructor
 
     #pragma region Method
@@ -194,25 +339,199 @@ public:
     bool solve(); // return true if exit normally. solve by multiple workers together.
 	bool check(Revenue &obj) const;
     void record() const; // save running log.
-	int vehicleVolume(const pb::OilDelivery_Vehicle& vehicle);// return total volume of the vehicle
+	int vehicleVolume(const pb::OilDelivery_Vehicle& vehicle) const;// return total volume of the vehicle
+
+    // objective of a complete or partial plan without checking feasibility.
+    Revenue evaluate(const Problem::Output &sln) const;
+    // make a plan from another run or a slightly different instance feasible for the current input.
+    void repair(Problem::Output &sln) const;
+
+    // apply demand changes to the input, then re-optimize the vehicle-periods around them in sln.
+    bool reoptimize(Problem::Output &sln, const List<DemandUpdate> &updates);
 
 protected:
     void init();
+    void initInstanceData(); // derive the flat tables for searching from input.
+    void preprocess(); // reduce the candidate stations and detect symmetries.
+    void extractFeatures();
+    // choose the engine and its parameters for the instance by a decision tree on the features.
+    void configureByFeatures();
+    void loadInitSolution();
+    // relaxation bound of the current input, shared by all solvers on the same instance in the process.
+    Revenue upperBound() const;
+    Revenue relaxationBound() const;
+    Hash::Key instanceHash() const;
+    // stop all workers if the objective of a plan found by any of them closes the gap to cfg.targetGap.
+    void reportObjective(Revenue obj);
     bool optimize(Solution &sln, ID workerId = 0); // optimize by a single worker.
+    // engines run by optimize() according to cfg.alg. they improve plan until timeout and leave the best one in it.
+    void iteratedLocalSearch(Plan &plan, ID workerId);
+    void grasp(Plan &plan, ID workerId);
+    void antColony(Plan &plan, ID workerId);
+    // fix-and-optimize matheuristic on vehicle-period pairs, run for Algorithm::MathematicallProgramming.
+    void fixAndOptimize(Plan &plan, ID workerId);
+    // island model. send the best plan of the worker to its neighbors every cfg.migrationInterval seconds,
+    // or at the end of every epoch in deterministic mode, and replace it by the best received plan if that
+    // one is better. return true if it is replaced.
+    bool migrate(Plan &bestPlan, ID workerId, Iteration iter);
+    // wait for all workers at the end of an epoch, and exchange the plans in increasing worker id.
+    bool synchronize(Plan &bestPlan, ID workerId, Iteration epoch);
+    // solve by a single worker for each configuration of raceConfigurations() in a race. only env.jobNum of
+    // them run at a time and those statistically behind are stopped early.
+    bool runRace();
+    // the engines with a few settings of their main parameters, based on cfg.
+    void raceConfigurations(List<Configuration> &cfgs) const;
+    // relink the result of the engine with the results of the other workers until timeout.
+    void relinkElites(Plan &plan, ID workerId);
+    // walk from plan towards guide by copying the loads of one differing vehicle-period at a time,
+    // then polish the best plan on the path. return true if plan is improved.
+    bool relinkPath(Plan &plan, const Plan &guide, Random &rng);
+
+    void initPlan(Plan &plan) const; // an empty plan.
+    void toPlan(const Problem::Output &sln, Plan &plan) const; // sln must be feasible.
+    void toOutput(const Plan &plan, Problem::Output &sln) const;
+    void initResiduals(Plan &plan) const;
+    // the residual demand of station in period, or 0 if it is served in another period.
+    int residualOf(const Plan &plan, ID period, ID station) const;
+    // add (sign = 1) or remove (sign = -1) the residuals of station in all periods.
+    void trackResiduals(Plan &plan, ID station, int sign) const;
+    Hash::Key loadKey(ID index, const Plan::CabinLoad &load) const {
+        return Hash::combine(Hash::combine(index, load.station), load.quantity);
+    }
+    Hash::Key residualKey(ID period, ID station, int residual) const {
+        return Hash::combine(Hash::mix(static_cast<Hash::Key>(period) * stationNumber + station), residual);
+    }
+
+    ID loadIndex(ID period, ID vehicle, ID cabin = 0) const { return period * cabinNumber + cabinOffsets[vehicle] + cabin; }
+    ID cabinNumberOf(ID vehicle) const { return cabinOffsets[vehicle + 1] - cabinOffsets[vehicle]; }
+
+    // the min and max station id loaded by vehicle in period, or (stationNumber, InvalidId) if it is idle.
+    void windowOf(const Plan &plan, ID period, ID vehicle, ID &minStationId, ID &maxStationId) const;
+    // the loads would keep the plan feasible if they replaced the loads of vehicle in period.
+    bool isAssignable(const Plan &plan, ID period, ID vehicle, const List<Plan::CabinLoad> &loads) const;
+    // delta evaluation. replace the loads of vehicle in period and update the cached objective.
+    void assign(Plan &plan, ID period, ID vehicle, const List<Plan::CabinLoad> &loads) const;
+    // log the replaced loads into changes.
+    void assign(Plan &plan, ID period, ID vehicle, const List<Plan::CabinLoad> &loads, List<LoadChange> &changes) const;
+    // undo the logged assignments in reverse order and clear the log.
+    void rollback(Plan &plan, List<LoadChange> &changes) const;
+    Revenue vehiclePeriodValue(const Plan &plan, ID period, ID vehicle) const;
+    Revenue vehiclePeriodValue(ID period, ID vehicle, const Plan::CabinLoad *loads) const;
+    // the value change of the vehicle-period by each move, which is assumed to be feasible.
+    void evaluateMoves(const Plan &plan, ID period, ID vehicle, MoveBatch &moves) const;
+    // exact oracle. the best loads of vehicle in period while the rest of the plan is fixed.
+    // the windows are searched by threadNum threads if there are many candidate stations.
+    Revenue optimizeVehiclePeriod(const Plan &plan, ID period, ID vehicle, List<Plan::CabinLoad> &loads, int threadNum = 1) const;
+    // re-optimize vehicle-periods one by one with the oracle until none of them can be improved.
+    // only the vehicle-periods in period are visited if it is valid.
+    bool localSearch(Plan &plan, Random &rng, ID period = Problem::InvalidId, int oracleThreadNum = 1);
+    bool localSearch(Plan &plan) { return localSearch(plan, rand); }
+    // move a cabin of each vehicle-period to a station around its window, taking the demand from
+    // the other vehicles in the same period if needed.
+    bool shiftLoads(Plan &plan, Random &rng);
+    // keep the station of every cabin and reallocate the quantities. fill the cabins with the residual
+    // demands and move the quantities shared by vehicles to the vehicle valuing them more.
+    bool allocateQuantities(Plan &plan) const;
+    // station-to-period assignment layer. the periods are independent once the period of each station
+    // is fixed, so a station is moved to another period by re-solving the two periods concurrently.
+    bool reassignStation(Plan &plan, Random &rng);
+    // move a station to another period, ejecting a station of the vehicle taking it to a third period,
+    // and so on. the chain is undone unless the objective is improved.
+    bool ejectStations(Plan &plan, Random &rng);
+    // re-solve each pair of vehicle-periods with overlapping windows once, in decreasing overlap. the pairs
+    // in a batch touch distinct vehicle-periods and are re-solved in parallel on copies of the plan.
+    bool resolvePairs(Plan &plan, Random &rng);
+    // release the pair and refill it by the oracle in both orders. changes are kept only on improvement.
+    bool resolvePair(Plan &plan, const VehiclePeriodPair &pair, List<LoadChange> &changes) const;
+    // the pairs of busy vehicle-periods whose windows overlap.
+    void overlappingPairs(const Plan &plan, List<VehiclePeriodPair> &pairs, Random &rng) const;
+    // fill the idle vehicle-periods one by one with the oracle results chosen by pick.
+    void construct(Plan &plan, const std::function<size_t(const List<Insertion>&)> &pick) const;
+    // randomized greedy construction. pick at random from the restricted candidate list.
+    void constructGreedily(Plan &plan, double alpha, Random &rng) const;
+    // pick by the roulette wheel on the values and the pheromone trails.
+    void constructByAnt(Plan &plan, const Pheromone &pheromone, Random &rng) const;
+    // variable neighborhood descent. restart from the cheapest neighborhood on every improvement.
+    bool variableNeighborhoodDescent(Plan &plan, Random &rng);
+    // make station unavailable in period on a private copy of a plan or until it is unblocked.
+    void blockStation(Plan &plan, ID period, ID station) const;
+    // undo blockStation().
+    void unblockStation(Plan &plan, ID period, ID station) const;
+    // remove the loads on station in period. the replaced loads are logged into changes if it is not null.
+    void releaseStation(Plan &plan, ID period, ID station, List<LoadChange> *changes = nullptr) const;
+    // clear the loads of vehicleNum random vehicles in a random period.
+    void perturb(Plan &plan, ID vehicleNum, Random &rng);
+    // return false if the plan has been reached by any worker before.
+    bool markSeen(Hash::Key planHash);
+
+    // every engine should poll it in its main loop and return its best solution once it is true.
+    bool isStopped() const {
+        if (Cancellation::isRequested() || stopped.load(std::memory_order_relaxed)) { return true; }
+        return timer.isTimeOut(); // it kills a deterministic run in the middle of an epoch.
+    }
+    // the engines poll it instead to leave the rest of the time to path relinking.
+    bool isEngineStopped() const { return (!cfg.deterministic && engineTimer.isTimeOut()) || isStopped(); }
     #pragma endregion Method
 
     #pragma region Field
 public:
     Problem::Input input;
     Problem::Output output;
-
-	ID periodNumber;
+    Solution initSln; // warm start shared by all workers. it is empty if there is no -init option.
+
+	ID periodNumber = 0; // it stays 0 until init().
+    ID stationNumber;
+    ID vehicleNumber;
+    ID cabinNumber; // total number of cabins of all vehicles.
+
+    Arr2D<int> demands; // demands[period][station].
+    Arr2D<double> unitValues; // unitValues[period][station] is the value of delivering one unit.
+    List<List<ID>> periodStations; // periodStations[period] lists the stations with demand in increasing id order.
+    List<List<ID>> periodStationsByUnitValue; // the same stations in decreasing unit value order.
+    List<Bitset> candidateStations; // the stations in periodStations[period].
+    List<ID> cabinOffsets; // the cabins of vehicle v are [cabinOffsets[v], cabinOffsets[v + 1]) in flat lists.
+    List<int> cabinVolumes; // cabinVolumes[cabinOffsets[v] + c].
+    List<int> vehicleVolumes;
+
+    // preprocessing results.
+    Arr2D<ID> periodRankings; // periodRankings[station][r] is the period with the r_th largest value.
+    List<ID> cabinOrders; // cabinOrders[cabinOffsets[v] + i] is the i_th largest cabin of vehicle v.
+    List<ID> vehicleClasses; // vehicles with the same cabin volumes share the same class.
+    ID vehicleClassNumber;
+    Revenue bound; // upper bound of the objective.
+    InstanceFeatures features;
+
+    mutable ShardedCache<OracleResult> oracleCache;
+    // reused by repair() and allocateQuantities(), which are only called by the main thread.
+    mutable Transportation transportation;
+    // the recent local optima reached by all workers.
+    std::mutex seenPlanMutex;
+    TabuSet seenPlans;
+    // migrationQueues[src * workerNum + dst] carries the plans from island src to island dst if they are neighbors.
+    List<std::unique_ptr<SpscRing<std::shared_ptr<const Plan>>>> migrationQueues;
+    List<double> nextMigrationTimes; // nextMigrationTimes[w] is only accessed by worker w.
+    // epochPlans[(epoch % 2) * workerNum + w] is the best plan of worker w at the end of the epoch in deterministic mode.
+    List<std::shared_ptr<const Plan>> epochPlans;
+    Barrier epochBarrier;
+    // elitePlans[w] is the engine result of worker w, or an empty plan if it is not ready.
+    std::mutex elitePlanMutex;
+    List<Plan> elitePlans;
 
     Environment env;
     Configuration cfg;
 
-    Random rand; // all random number in Solver must be generated by this.
+    Random rand; // all random number in Solver must be generated by this or the streams derived from it.
+    List<Random> workerRands; // workerRands[w] is only used by worker w. the seeds only depend on env.randSeed.
     Timer timer; // the solve() should return before it is timeout.
+    Timer engineTimer; // the engines should return before it is timeout.
+    // statistics of the oracle calls searched by work stealing.
+    mutable std::atomic<long long> parallelOracleNum;
+    mutable std::atomic<long long> stealNum;
+    mutable std::atomic<long long> branchNodeNum; // the search tree nodes visited by all threads.
+    mutable std::atomic<long long> busiestBranchNodeNum; // the sum of the thread number times the nodes of the busiest thread.
+    std::atomic<bool> stopped; // the gap is closed, or the workers agree to stop at the end of an epoch.
+    Race *race = nullptr; // the race which the solver runs in as a contestant.
+    ID contestantId = 0;
     Iteration iteration;
     #pragma endregion Field
 }; // Solver 
@@ -0,0 +1,58 @@
+////////////////////////////////
+/// usage : 1.	bounded lock-free queue between exactly one producer thread and one consumer thread.
+///
+/// note  : 1.	push() and pop() never block. they fail at once if the queue is full or empty.
+///         2.	the indices only grow, and the slot of an index is (index % Capacity).
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_SPSC_RING_H
+#define SMART_LCG_OIL_DELIVERY_SPSC_RING_H
+
+
+#include "Config.h"
+
+#include <atomic>
+#include <utility>
+
+#include <cstddef>
+
+
+namespace lcg {
+
+template<typename T, int Capacity = 4>
+class SpscRing {
+public:
+    SpscRing() : head(0), tail(0) {}
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+
+    // called by the producer only.
+    bool push(const T &item) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= Capacity) { return false; }
+        items[t % Capacity] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // called by the consumer only.
+    bool pop(T &item) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) { return false; }
+        item = std::move(items[h % Capacity]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+protected:
+    // the indices are on separate cache lines so that the two threads do not invalidate each other.
+    alignas(64) std::atomic<std::size_t> head; // the next slot to pop.
+    alignas(64) std::atomic<std::size_t> tail; // the next slot to push.
+    T items[Capacity];
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_SPSC_RING_H
@@ -0,0 +1,47 @@
+////////////////////////////////
+/// usage : 1.	tabu memory of the most recent hash keys.
+///
+/// note  : 1.	the oldest key is forgotten once the tenure is reached.
+///         2.	nothing is tabu if the tenure is 0.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_TABU_SET_H
+#define SMART_LCG_OIL_DELIVERY_TABU_SET_H
+
+
+#include "Config.h"
+
+#include "Common.h"
+#include "Utility.h"
+
+
+namespace lcg {
+
+class TabuSet {
+public:
+    explicit TabuSet(int tenure = 0) : keys(tenure), next(0) {}
+
+
+    bool contains(Hash::Key key) const { return tabuKeys.find(key) != tabuKeys.end(); }
+
+    // return false if the key is already tabu.
+    bool insert(Hash::Key key) {
+        if (keys.empty()) { return true; }
+        if (contains(key)) { return false; }
+        if (tabuKeys.size() >= keys.size()) { tabuKeys.erase(keys[next]); }
+        keys[next] = key;
+        tabuKeys.insert(key);
+        next = (next + 1) % keys.size();
+        return true;
+    }
+
+protected:
+    List<Hash::Key> keys; // ring buffer in insertion order.
+    size_t next;
+    HashSet<Hash::Key> tabuKeys;
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_TABU_SET_H
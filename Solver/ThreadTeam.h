@@ -0,0 +1,107 @@
+////////////////////////////////
+/// usage : 1.	run a job on a team of threads which stay alive across the calls.
+///
+/// note  : 1.	the caller is thread 0 of the team, and the other threads are parked on a condition
+///             variable between the jobs, so a call costs a wake-up instead of a thread start-up.
+///         2.	each thread owns its team by local(), so the workers of the solver never share one.
+///         3.	the team grows to the largest thread number requested and never shrinks.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_THREAD_TEAM_H
+#define SMART_LCG_OIL_DELIVERY_THREAD_TEAM_H
+
+
+#include "Config.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace lcg {
+
+class ThreadTeam {
+public:
+    using Job = std::function<void(int threadId)>;
+
+
+    ThreadTeam() : job(nullptr), jobThreadNum(0), generation(0), pendingNum(0), quitting(false) {}
+    ThreadTeam(const ThreadTeam&) = delete;
+    ThreadTeam& operator=(const ThreadTeam&) = delete;
+    ~ThreadTeam() {
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            quitting = true;
+        }
+        jobCv.notify_all();
+        for (auto t = threads.begin(); t != threads.end(); ++t) { t->join(); }
+    }
+
+
+    // the team of the calling thread.
+    static ThreadTeam& local() {
+        static thread_local ThreadTeam team;
+        return team;
+    }
+
+    // call j(t) for every t in [0, threadNum) on threadNum threads and return when all calls are done.
+    void run(int threadNum, const Job &j) {
+        if (threadNum <= 1) {
+            j(0);
+            return;
+        }
+        // only the caller changes the generation, so the new threads start from the current one.
+        while (static_cast<int>(threads.size()) < threadNum - 1) {
+            int id = static_cast<int>(threads.size()) + 1;
+            long long startGeneration = generation;
+            threads.emplace_back([this, id, startGeneration]() { park(id, startGeneration); });
+        }
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            job = &j;
+            jobThreadNum = threadNum;
+            pendingNum = threadNum - 1;
+            ++generation;
+        }
+        jobCv.notify_all();
+        j(0);
+        std::unique_lock<std::mutex> lock(mtx);
+        doneCv.wait(lock, [&]() { return pendingNum == 0; });
+        job = nullptr;
+    }
+
+protected:
+    void park(int id, long long seenGeneration) {
+        std::unique_lock<std::mutex> lock(mtx);
+        for (;;) {
+            jobCv.wait(lock, [&]() { return quitting || (generation != seenGeneration); });
+            if (quitting) { return; }
+            seenGeneration = generation;
+            if (id >= jobThreadNum) { continue; }
+            const Job *j = job;
+            lock.unlock();
+            (*j)(id);
+            lock.lock();
+            if (--pendingNum == 0) { doneCv.notify_one(); }
+        }
+    }
+
+
+    std::mutex mtx;
+    std::condition_variable jobCv; // the parked threads wait for a new generation.
+    std::condition_variable doneCv; // the caller waits for the pending threads.
+    std::vector<std::thread> threads; // thread t + 1 of the team.
+
+    const Job *job;
+    int jobThreadNum;
+    long long generation; // the number of jobs started.
+    int pendingNum; // the threads which have not finished the current job.
+    bool quitting;
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_THREAD_TEAM_H
@@ -1,5 +1,7 @@
 #include "Utility.h"
 
+#include <csignal>
+
 #if _OS_MS_WINDOWS
 #include <Windows.h>
 #include <Psapi.h>
@@ -7,12 +9,30 @@
 // EXTEND[lcg][9]: get memory usage on *nix.
 #endif // _OS_MS_WINDOWS
 
+#if _CC_MS_VC
+#include <intrin.h>
+#endif // _CC_MS_VC
+
 
 using namespace std;
 
 
 namespace lcg {
 
+static void onTerminationSignal(int signalId) {
+    signal(signalId, SIG_DFL);
+    Cancellation::request();
+}
+
+void Cancellation::handleTerminationSignals() {
+    reset(); // initialize the flag outside the signal handlers.
+    signal(SIGINT, onTerminationSignal);
+    signal(SIGTERM, onTerminationSignal);
+    #ifdef SIGBREAK
+    signal(SIGBREAK, onTerminationSignal);
+    #endif // SIGBREAK
+}
+
 System::MemoryUsage System::memoryUsage() {
     MemoryUsage mu = { 0, 0 };
 
@@ -49,4 +69,23 @@ System::MemoryUsage System::peakMemoryUsage() {
     return mu;
 }
 
+bool System::supportsAvx2() {
+    #if _CC_MS_VC && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) { return false; }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    // the os must save the ymm registers on context switches.
+    if (!osxsave || !avx || ((_xgetbv(0) & 6) != 6)) { return false; }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+    #elif (_CC_GNU_GCC || _CC_CLANG) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2") != 0;
+    #else
+    return false;
+    #endif // _CC_MS_VC
+}
+
 }
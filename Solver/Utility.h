@@ -11,14 +11,18 @@
 #include "Config.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <initializer_list>
 #include <vector>
 #include <map>
+#include <mutex>
 #include <random>
 #include <iostream>
 #include <iomanip>
 
+#include <cstdint>
 #include <cstring>
 #include <cstdlib>
 #include <ctime>
@@ -444,6 +448,73 @@ protected:
 };
 
 
+// process-wide stop request which can be raised from signal handlers.
+class Cancellation {
+public:
+    // route SIGINT/SIGTERM (and SIGBREAK on Windows) to request().
+    // a second signal falls back to the default handler to kill the process at once.
+    static void handleTerminationSignals();
+
+    static void request() { flag().store(true, std::memory_order_relaxed); }
+    static void reset() { flag().store(false, std::memory_order_relaxed); }
+    static bool isRequested() { return flag().load(std::memory_order_relaxed); }
+
+protected:
+    // the atomic must be lock-free so that it is safe to be modified in signal handlers.
+    static std::atomic<bool>& flag() {
+        static std::atomic<bool> requested(false);
+        return requested;
+    }
+};
+
+
+// reusable barrier for a fixed number of threads. the last arriving thread runs the completion
+// before releasing the others. the waiting threads leave on cancellation or once isLeaving() is true
+// instead of getting stuck, e.g., when another thread is killed before it arrives.
+class Barrier {
+public:
+    static constexpr int PollIntervalInMillisecond = 10;
+
+
+    explicit Barrier(int threadNumber = 0) : threadNum(threadNumber), arrivedNum(0), generation(0) {}
+
+
+    void init(int threadNumber) {
+        std::lock_guard<std::mutex> guard(mtx);
+        threadNum = threadNumber;
+        arrivedNum = 0;
+    }
+
+    // return false if it is left on cancellation or by isLeaving().
+    template<typename Completion, typename Leaving>
+    bool arriveAndWait(Completion onComplete, Leaving isLeaving) {
+        std::unique_lock<std::mutex> lock(mtx);
+        long long gen = generation;
+        if (++arrivedNum >= threadNum) {
+            onComplete();
+            arrivedNum = 0;
+            ++generation;
+            cv.notify_all();
+            return true;
+        }
+        while (gen == generation) {
+            if (Cancellation::isRequested() || isLeaving()) { return false; }
+            cv.wait_for(lock, std::chrono::milliseconds(PollIntervalInMillisecond));
+        }
+        return true;
+    }
+    template<typename Completion>
+    bool arriveAndWait(Completion onComplete) { return arriveAndWait(onComplete, []() { return false; }); }
+
+protected:
+    std::mutex mtx;
+    std::condition_variable cv;
+    int threadNum;
+    int arrivedNum;
+    long long generation; // the number of times all threads have arrived.
+};
+
+
 class DateTime {
 public:
     static constexpr int MinutesPerDay = 60 * 24;
@@ -715,6 +786,9 @@ public:
 
     static MemoryUsage memoryUsage();
     static MemoryUsage peakMemoryUsage();
+
+    // whether both the cpu and the os support avx2 instructions.
+    static bool supportsAvx2();
 };
 
 
@@ -746,6 +820,21 @@ public:
     }
 };
 
+
+class Hash {
+public:
+    using Key = std::uint64_t;
+
+    // the finalizer of splitmix64, which turns consecutive integers into well distributed keys.
+    static Key mix(Key x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+    static Key combine(Key seed, Key value) { return mix(seed ^ mix(value)); }
+};
+
 }
 
 
@@ -0,0 +1,88 @@
+#include "WindowBound.h"
+
+#if LCG_SIMD && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define LCG_AVX2_KERNEL  1
+#include <immintrin.h>
+#else
+#define LCG_AVX2_KERNEL  0
+#endif // LCG_SIMD
+
+#include "Bitset.h"
+#include "Utility.h"
+
+
+#if _CC_MS_VC
+#define LCG_TARGET_AVX2
+#else
+#define LCG_TARGET_AVX2  __attribute__((target("avx2")))
+#endif // _CC_MS_VC
+
+
+using namespace std;
+
+
+namespace lcg {
+
+void WindowBound::lastAliveOffsets(const Candidates &candidates, const Vehicle &vehicle, double threshold, int *lastOffsets) {
+    fill(lastOffsets, lastOffsets + candidates.num, 0);
+    double objBound = vehicle.valueBound * vehicle.loadBound / vehicle.volume;
+    bool simd = avx2Enabled();
+    // the load sharing of a window is at most cabinNum / (cabinNum + offset) as station ids are distinct.
+    for (int offset = 1; offset < candidates.num; ++offset) {
+        if (objBound * vehicle.cabinNum / (vehicle.cabinNum + offset) <= threshold) { break; }
+        if (simd) {
+            avx2Kernel(candidates, vehicle, threshold, offset, lastOffsets);
+        } else {
+            scalarKernel(candidates, vehicle, threshold, offset, 0, lastOffsets);
+        }
+    }
+}
+
+bool WindowBound::avx2Enabled() {
+    #if LCG_AVX2_KERNEL
+    static const bool enabled = System::supportsAvx2();
+    return enabled;
+    #else
+    return false;
+    #endif // LCG_AVX2_KERNEL
+}
+
+void WindowBound::scalarKernel(const Candidates &candidates, const Vehicle &vehicle, double threshold, int offset, int lo, int *lastOffsets) {
+    // compare value * load * cabinNum / (cabinNum + span) / volume with threshold without division.
+    double scaledThreshold = threshold * vehicle.volume;
+    for (int hi = lo + offset; hi < candidates.num; ++lo, ++hi) {
+        double value = (min)(vehicle.valueBound, candidates.valuePrefixes[hi + 1] - candidates.valuePrefixes[lo]);
+        double load = (min)(vehicle.loadBound, candidates.residualPrefixes[hi + 1] - candidates.residualPrefixes[lo]);
+        double span = candidates.ids[hi] - candidates.ids[lo];
+        if (value * load * vehicle.cabinNum > scaledThreshold * (vehicle.cabinNum + span)) { lastOffsets[lo] = offset; }
+    }
+}
+
+#if LCG_AVX2_KERNEL
+LCG_TARGET_AVX2 void WindowBound::avx2Kernel(const Candidates &candidates, const Vehicle &vehicle, double threshold, int offset, int *lastOffsets) {
+    constexpr int LaneNum = 4;
+
+    __m256d valueBound = _mm256_set1_pd(vehicle.valueBound);
+    __m256d loadBound = _mm256_set1_pd(vehicle.loadBound);
+    __m256d cabinNum = _mm256_set1_pd(vehicle.cabinNum);
+    __m256d scaledThreshold = _mm256_set1_pd(threshold * vehicle.volume);
+    int lo = 0;
+    for (; lo + offset + LaneNum <= candidates.num; lo += LaneNum) {
+        int hi = lo + offset;
+        __m256d value = _mm256_sub_pd(_mm256_loadu_pd(candidates.valuePrefixes + hi + 1), _mm256_loadu_pd(candidates.valuePrefixes + lo));
+        __m256d load = _mm256_sub_pd(_mm256_loadu_pd(candidates.residualPrefixes + hi + 1), _mm256_loadu_pd(candidates.residualPrefixes + lo));
+        __m256d span = _mm256_sub_pd(_mm256_loadu_pd(candidates.ids + hi), _mm256_loadu_pd(candidates.ids + lo));
+        __m256d lhs = _mm256_mul_pd(_mm256_mul_pd(_mm256_min_pd(valueBound, value), _mm256_min_pd(loadBound, load)), cabinNum);
+        __m256d rhs = _mm256_mul_pd(scaledThreshold, _mm256_add_pd(cabinNum, span));
+        int alive = _mm256_movemask_pd(_mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ));
+        for (; alive != 0; alive &= (alive - 1)) { lastOffsets[lo + Bitset::ctz(alive)] = offset; }
+    }
+    scalarKernel(candidates, vehicle, threshold, offset, lo, lastOffsets);
+}
+#else
+void WindowBound::avx2Kernel(const Candidates &candidates, const Vehicle &vehicle, double threshold, int offset, int *lastOffsets) {
+    scalarKernel(candidates, vehicle, threshold, offset, 0, lastOffsets);
+}
+#endif // LCG_AVX2_KERNEL
+
+}
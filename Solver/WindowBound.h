@@ -0,0 +1,50 @@
+////////////////////////////////
+/// usage : 1.	upper bounds on the value of a vehicle-period for every window of candidate stations.
+///
+/// note  : 1.	the windows of the same span are scored together by an avx2 kernel if the cpu
+///             supports it, otherwise by the scalar kernel.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_WINDOW_BOUND_H
+#define SMART_LCG_OIL_DELIVERY_WINDOW_BOUND_H
+
+
+#include "Config.h"
+
+
+namespace lcg {
+
+class WindowBound {
+public:
+    // the candidate stations of a vehicle-period in structure of arrays.
+    struct Candidates {
+        int num;
+        const double *ids; // station ids in increasing order.
+        const double *valuePrefixes; // valuePrefixes[i] is the residual value of candidates[0, i).
+        const double *residualPrefixes; // residualPrefixes[i] is the residual demand of candidates[0, i).
+    };
+
+    struct Vehicle {
+        double cabinNum;
+        double volume;
+        double valueBound; // the max total value of the cabins.
+        double loadBound; // the max total load of the cabins.
+    };
+
+
+    // lastOffsets[lo] is set to the max offset such that the window [lo, lo + offset] may be worth more
+    // than threshold, or 0 if no window starting from lo may be.
+    static void lastAliveOffsets(const Candidates &candidates, const Vehicle &vehicle, double threshold, int *lastOffsets);
+
+    static bool avx2Enabled();
+
+protected:
+    // score the windows [lo, lo + offset] for all lo.
+    static void scalarKernel(const Candidates &candidates, const Vehicle &vehicle, double threshold, int offset, int lo, int *lastOffsets);
+    static void avx2Kernel(const Candidates &candidates, const Vehicle &vehicle, double threshold, int offset, int *lastOffsets);
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_WINDOW_BOUND_H
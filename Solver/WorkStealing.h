@@ -0,0 +1,128 @@
+////////////////////////////////
+/// usage : 1.	parallel branch and bound on a tree whose nodes are explored independently.
+///
+/// note  : 1.	each thread owns a deque of nodes. it pushes and pops at the bottom so that it goes
+///             deep first, while an idle thread steals from the top of another deque, where the
+///             shallowest and usually the largest subtrees wait.
+///         2.	a node is a coarse subtree, so each deque is simply guarded by its own mutex.
+///         3.	the threads prune against the incumbent, which is shared by an atomic objective.
+///         4.	the threads come from the team of the caller, which is kept alive across the searches.
+////////////////////////////////
+
+#ifndef SMART_LCG_OIL_DELIVERY_WORK_STEALING_H
+#define SMART_LCG_OIL_DELIVERY_WORK_STEALING_H
+
+
+#include "Config.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ThreadTeam.h"
+
+
+namespace lcg {
+
+// the best objective found by any thread, which is only raised.
+class Incumbent {
+public:
+    explicit Incumbent(double initValue = 0.0) : value(initValue) {}
+
+    double get() const { return value.load(std::memory_order_relaxed); }
+
+    // return true if obj is strictly better and becomes the new incumbent.
+    bool raise(double obj) {
+        double cur = value.load(std::memory_order_relaxed);
+        while (obj > cur) {
+            if (value.compare_exchange_weak(cur, obj, std::memory_order_relaxed)) { return true; }
+        }
+        return false;
+    }
+
+protected:
+    std::atomic<double> value;
+};
+
+template<typename Node>
+class WorkStealingSearch {
+public:
+    // explore the trees under roots by threadNum threads until no node is left. the roots are dealt to the
+    // threads in turn. visit(threadId, node, push) explores a node and calls push(child) for its subtrees.
+    template<typename Visit>
+    void run(int threadNum, const std::vector<Node> &roots, Visit visit) {
+        std::vector<Deque> deques(threadNum);
+        for (size_t i = 0; i < roots.size(); ++i) { deques[i % threadNum].nodes.push_back(roots[i]); }
+        visitNums.assign(threadNum, 0);
+        stealNums.assign(threadNum, 0);
+        // the nodes pushed but not explored yet. a parent is done only after its children are pushed.
+        std::atomic<long long> pendingNum(static_cast<long long>(roots.size()));
+
+        auto work = [&](int t) {
+            auto push = [&](const Node &child) {
+                ++pendingNum;
+                std::lock_guard<std::mutex> guard(deques[t].mtx);
+                deques[t].nodes.push_back(child);
+            };
+            Node node;
+            while (pendingNum.load() > 0) {
+                if (!popBottom(deques[t], node)) {
+                    if (!steal(deques, t, node)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    ++stealNums[t];
+                }
+                visit(t, node, push);
+                ++visitNums[t];
+                --pendingNum;
+            }
+        };
+
+        ThreadTeam::local().run(threadNum, work);
+    }
+
+    // the statistics of the last run.
+    const std::vector<long long>& visitNumsOfThreads() const { return visitNums; }
+    const std::vector<long long>& stealNumsOfThreads() const { return stealNums; }
+
+protected:
+    struct Deque {
+        std::mutex mtx;
+        std::deque<Node> nodes; // the front is the top and the back is the bottom.
+    };
+
+
+    static bool popBottom(Deque &d, Node &node) {
+        std::lock_guard<std::mutex> guard(d.mtx);
+        if (d.nodes.empty()) { return false; }
+        node = d.nodes.back();
+        d.nodes.pop_back();
+        return true;
+    }
+
+    // take the top node of the first non-empty deque after the one of thief.
+    static bool steal(std::vector<Deque> &deques, int thief, Node &node) {
+        int threadNum = static_cast<int>(deques.size());
+        for (int i = 1; i < threadNum; ++i) {
+            Deque &victim(deques[(thief + i) % threadNum]);
+            std::lock_guard<std::mutex> guard(victim.mtx);
+            if (victim.nodes.empty()) { continue; }
+            node = victim.nodes.front();
+            victim.nodes.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+
+    std::vector<long long> visitNums;
+    std::vector<long long> stealNums;
+};
+
+}
+
+
+#endif // SMART_LCG_OIL_DELIVERY_WORK_STEALING_H